@@ -2,769 +2,375 @@
 Real AI Engine - C++ Implementation
 High-performance AI inference engine for code generation and analysis
 Supports TensorFlow C++, ONNX Runtime, and custom neural networks
+
+Command-line entry point; the engine itself is libaiengine (lib/, with
+public headers under include/ai_engine/)
 */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
-#include <string>
-#include <vector>
 #include <map>
 #include <memory>
-#include <fstream>
-#include <sstream>
-#include <algorithm>
-#include <chrono>
-#include <thread>
 #include <mutex>
-#include <queue>
-#include <functional>
-#include <regex>
-#include <cmath>
-#include <random>
-
-// JSON handling (you may need to install nlohmann/json)
-#ifdef HAS_JSON
-#include <nlohmann/json.hpp>
-using json = nlohmann::json;
-#endif
-
-// TensorFlow C++ API (optional, requires TensorFlow C++ installation)
-#ifdef HAS_TENSORFLOW
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/core/framework/tensor.h"
-#endif
-
-// ONNX Runtime (optional, for running ONNX models)
-#ifdef HAS_ONNX
-#include <onnxruntime_cxx_api.h>
-#endif
-
-namespace AIEngine {
-
-enum class Language {
-    PYTHON,
-    CPP,
-    JAVASCRIPT,
-    HTML,
-    CSS,
-    UNKNOWN
-};
-
-enum class RequestType {
-    GENERATE_CODE,
-    ANALYZE_CODE,
-    EXECUTE_CODE,
-    OPTIMIZE_CODE
-};
+#include <string>
+#include <thread>
+#include <vector>
 
-struct CodeRequest {
-    std::string prompt;
-    Language language;
-    std::string context;
-    int max_tokens = 1000;
-    float temperature = 0.7f;
-    RequestType type = RequestType::GENERATE_CODE;
-};
+#include "ai_engine/ai_engine.h"
 
-struct CodeResponse {
-    std::string code;
-    std::string explanation;
-    float confidence;
-    std::string execution_result;
-    std::string error;
-    std::chrono::milliseconds processing_time;
-};
+namespace {
 
-class TokenProcessor {
-private:
-    std::map<std::string, int> vocab;
-    std::map<int, std::string> reverse_vocab;
-    int vocab_size;
-    
-public:
-    TokenProcessor() : vocab_size(0) {
-        // Initialize basic vocabulary
-        initializeVocab();
-    }
-    
-    void initializeVocab() {
-        // Basic programming tokens
-        std::vector<std::string> basic_tokens = {
-            "<pad>", "<unk>", "<start>", "<end>",
-            "def", "class", "if", "else", "for", "while", "return",
-            "int", "float", "string", "bool", "void",
-            "#include", "using", "namespace", "std",
-            "function", "var", "let", "const", "return",
-            "(", ")", "{", "}", "[", "]", ";", ":", ",", ".",
-            "+", "-", "*", "/", "=", "==", "!=", "<", ">", "<=", ">="
-        };
-        
-        for (size_t i = 0; i < basic_tokens.size(); ++i) {
-            vocab[basic_tokens[i]] = i;
-            reverse_vocab[i] = basic_tokens[i];
-        }
-        vocab_size = basic_tokens.size();
-    }
-    
-    std::vector<int> tokenize(const std::string& text) {
-        std::vector<int> tokens;
-        std::istringstream iss(text);
-        std::string word;
-        
-        while (iss >> word) {
-            auto it = vocab.find(word);
-            if (it != vocab.end()) {
-                tokens.push_back(it->second);
-            } else {
-                tokens.push_back(vocab["<unk>"]);
-            }
-        }
-        
-        return tokens;
-    }
-    
-    std::string detokenize(const std::vector<int>& tokens) {
-        std::string result;
-        for (int token : tokens) {
-            auto it = reverse_vocab.find(token);
-            if (it != reverse_vocab.end()) {
-                if (!result.empty()) result += " ";
-                result += it->second;
-            }
-        }
-        return result;
-    }
+struct CommandLineOptions {
+    bool daemon = false;
+    bool help = false;
+    std::string socket_path = "/tmp/ai_engine.sock";
+    std::string shm_name;
+    std::string http_host = "127.0.0.1";
+    int http_port = 0;
+    std::string request_file;
+    std::string batch_file;
+    bool batch_unordered = false;
+    bool stats = false;
+    std::string trace_file;
+    bool perf_counters = false;
+    std::string snapshot_file;
+    std::string save_snapshot_file;
+    std::string templates_dir;
+    AIEngine::IoBackendKind io_backend = AIEngine::IoBackendKind::AUTO;
+    size_t workers = std::max(1u, std::thread::hardware_concurrency());
 };
 
-class NeuralNetwork {
-private:
-    struct Layer {
-        std::vector<std::vector<float>> weights;
-        std::vector<float> biases;
-        std::function<float(float)> activation;
-        
-        Layer(int input_size, int output_size, std::function<float(float)> act) 
-            : activation(act) {
-            // Initialize weights with Xavier initialization
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            float limit = std::sqrt(6.0f / (input_size + output_size));
-            std::uniform_real_distribution<float> dis(-limit, limit);
-            
-            weights.resize(output_size, std::vector<float>(input_size));
-            biases.resize(output_size);
-            
-            for (int i = 0; i < output_size; ++i) {
-                for (int j = 0; j < input_size; ++j) {
-                    weights[i][j] = dis(gen);
-                }
-                biases[i] = dis(gen);
-            }
-        }
-    };
-    
-    std::vector<Layer> layers;
-    
-    static float relu(float x) { return std::max(0.0f, x); }
-    static float sigmoid(float x) { return 1.0f / (1.0f + std::exp(-x)); }
-    static float tanh_activation(float x) { return std::tanh(x); }
-    
-public:
-    NeuralNetwork() {
-        // Simple transformer-like architecture for code generation
-        // Embedding layer (simulated)
-        layers.emplace_back(512, 256, relu);
-        // Hidden layers
-        layers.emplace_back(256, 256, relu);
-        layers.emplace_back(256, 256, relu);
-        // Output layer
-        layers.emplace_back(256, 512, sigmoid);
-    }
-    
-    std::vector<float> forward(const std::vector<float>& input) {
-        std::vector<float> current = input;
-        
-        for (const auto& layer : layers) {
-            std::vector<float> next(layer.weights.size());
-            
-            for (size_t i = 0; i < layer.weights.size(); ++i) {
-                float sum = layer.biases[i];
-                for (size_t j = 0; j < current.size() && j < layer.weights[i].size(); ++j) {
-                    sum += current[j] * layer.weights[i][j];
-                }
-                next[i] = layer.activation(sum);
-            }
-            
-            current = std::move(next);
-        }
-        
-        return current;
-    }
-};
+std::atomic<AIEngine::SocketServer*> active_daemon{nullptr};
+std::atomic<AIEngine::SocketServer*> active_http{nullptr};
+std::atomic<AIEngine::ShmServer*> active_shm{nullptr};
 
-class CodeGenerator {
-private:
-    std::unique_ptr<NeuralNetwork> model;
-    std::unique_ptr<TokenProcessor> tokenizer;
-    std::map<Language, std::vector<std::string>> templates;
-    
-public:
-    CodeGenerator() : model(std::make_unique<NeuralNetwork>()),
-                     tokenizer(std::make_unique<TokenProcessor>()) {
-        initializeTemplates();
-    }
-    
-    void initializeTemplates() {
-        // Python templates
-        templates[Language::PYTHON] = {
-            R"(def {function_name}({params}):
-    """
-    {description}
-    """
-    {body}
-    return result)",
-            
-            R"(class {class_name}:
-    def __init__(self{params}):
-        {init_body}
-    
-    def {method_name}(self{method_params}):
-        {method_body})",
-            
-            R"(import {module}
-from {package} import {items}
+void handleStopSignal(int) {
+    if (AIEngine::SocketServer* daemon = active_daemon.load()) daemon->requestStop();
+    if (AIEngine::SocketServer* http = active_http.load()) http->requestStop();
+    if (AIEngine::ShmServer* shm = active_shm.load()) shm->requestStop();
+}
 
-def main():
-    {main_body}
+// Set by SIGHUP, acted on by the template reloader thread of runServers
+std::atomic<bool> reload_requested{false};
 
-if __name__ == "__main__":
-    main())"
-        };
-        
-        // C++ templates
-        templates[Language::CPP] = {
-            R"(#include <iostream>
-#include <vector>
-#include <string>
-using namespace std;
+void handleReloadSignal(int) {
+    reload_requested.store(true);
+}
 
-{return_type} {function_name}({params}) {
-    {body}
+void clearActiveServers() {
+    active_daemon.store(nullptr);
+    active_http.store(nullptr);
+    active_shm.store(nullptr);
 }
 
-int main() {
-    {main_body}
-    return 0;
-})",
-            
-            R"(class {class_name} {
-private:
-    {private_members}
-    
-public:
-    {class_name}({constructor_params}) {
-        {constructor_body}
-    }
-    
-    {return_type} {method_name}({method_params}) {
-        {method_body}
-    }
-};)",
-            
-            R"(#include <iostream>
-#include <algorithm>
-#include <vector>
-using namespace std;
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n\n";
+    std::cout << "Without options, runs a single example request and exits.\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --daemon           Serve requests on a Unix domain socket\n";
+    std::cout << "  --socket PATH      Socket path for --daemon (default /tmp/ai_engine.sock)\n";
+    std::cout << "  --shm NAME         Serve requests on a shared memory channel (e.g. /ai_engine)\n";
+    std::cout << "  --http PORT        Serve /api/generate and /api/analyze over HTTP/1.1\n";
+    std::cout << "  --host ADDR        Address for --http (default 127.0.0.1)\n";
+    std::cout << "  --workers N        Worker threads per transport (default: hardware threads)\n";
+    std::cout << "  --io-backend KIND  Socket I/O for --daemon/--http: auto, uring or epoll (default auto)\n";
+    std::cout << "  --request FILE     Process one /api/generate JSON body read from FILE and print the result\n";
+    std::cout << "  --batch FILE       Process JSONL requests from FILE (- for stdin), one JSON response per line\n";
+    std::cout << "  --unordered        With --batch, write responses as they finish, tagged with \"line\"\n";
+    std::cout << "  --stats            Print request counts and latency percentiles to stderr on exit\n";
+    std::cout << "  --perf-counters    Sample cycles, instructions, cache and branch misses per stage (with --stats, /metrics)\n";
+    std::cout << "  --trace FILE       Record tracing spans and write them as Chrome trace JSON to FILE on exit\n";
+    std::cout << "  --templates DIR    Load templates from DIR/<language>/<name> files; SIGHUP reloads them\n";
+    std::cout << "  --snapshot FILE    Start from the engine state saved in FILE instead of initialising it\n";
+    std::cout << "  --save-snapshot FILE  Write the initialised engine state to FILE and exit\n";
+    std::cout << "  --help             Show this help message\n";
+}
 
-template<typename T>
-class {template_class} {
-public:
-    {template_body}
-};)"
-        };
-        
-        // JavaScript templates
-        templates[Language::JAVASCRIPT] = {
-            R"(function {function_name}({params}) {
-    {body}
-    return result;
-})",
-            
-            R"(class {class_name} {
-    constructor({params}) {
-        {constructor_body}
-    }
-    
-    {method_name}({method_params}) {
-        {method_body}
-    }
-})",
-            
-            R"(const {const_name} = ({params}) => {
-    {body}
-};)"
-        };
-    }
-    
-    CodeResponse generateCode(const CodeRequest& request) {
-        auto start_time = std::chrono::high_resolution_clock::now();
-        
-        try {
-            std::string generated_code;
-            
-            // Use neural network for generation (simplified)
-            if (useNeuralGeneration(request)) {
-                generated_code = generateWithNN(request);
+bool parseCommandLine(int argc, char** argv, CommandLineOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        
+        if (arg == "--daemon") {
+            options.daemon = true;
+        } else if (arg == "--socket" && i + 1 < argc) {
+            options.socket_path = argv[++i];
+        } else if (arg == "--shm" && i + 1 < argc) {
+            options.shm_name = argv[++i];
+            if (options.shm_name.empty() || options.shm_name[0] != '/') {
+                options.shm_name.insert(0, "/");
+            }
+        } else if (arg == "--http" && i + 1 < argc) {
+            options.http_port = std::atoi(argv[++i]);
+            if (options.http_port <= 0 || options.http_port > 65535) {
+                std::cerr << "Invalid port: " << argv[i] << "\n";
+                return false;
+            }
+        } else if (arg == "--host" && i + 1 < argc) {
+            options.http_host = argv[++i];
+        } else if (arg == "--workers" && i + 1 < argc) {
+            options.workers = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--io-backend" && i + 1 < argc) {
+            std::string kind = argv[++i];
+            if (kind == "auto") {
+                options.io_backend = AIEngine::IoBackendKind::AUTO;
+            } else if (kind == "uring" || kind == "io_uring") {
+                options.io_backend = AIEngine::IoBackendKind::URING;
+            } else if (kind == "epoll") {
+                options.io_backend = AIEngine::IoBackendKind::EPOLL;
             } else {
-                // Fallback to template-based generation
-                generated_code = generateWithTemplate(request);
+                std::cerr << "Unknown I/O backend: " << kind << "\n";
+                return false;
             }
-            
-            auto end_time = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-            
-            return CodeResponse{
-                generated_code,
-                "Generated using C++ AI engine",
-                0.85f,
-                "",
-                "",
-                duration
-            };
-            
-        } catch (const std::exception& e) {
-            auto end_time = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-            
-            return CodeResponse{
-                "",
-                "Code generation failed",
-                0.0f,
-                "",
-                e.what(),
-                duration
-            };
+        } else if (arg == "--request" && i + 1 < argc) {
+            options.request_file = argv[++i];
+        } else if (arg == "--batch" && i + 1 < argc) {
+            options.batch_file = argv[++i];
+        } else if (arg == "--unordered") {
+            options.batch_unordered = true;
+        } else if (arg == "--stats") {
+            options.stats = true;
+        } else if (arg == "--perf-counters") {
+            options.perf_counters = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            options.trace_file = argv[++i];
+        } else if (arg == "--templates" && i + 1 < argc) {
+            options.templates_dir = argv[++i];
+        } else if (arg == "--snapshot" && i + 1 < argc) {
+            options.snapshot_file = argv[++i];
+        } else if (arg == "--save-snapshot" && i + 1 < argc) {
+            options.save_snapshot_file = argv[++i];
+        } else if (arg == "--help" || arg == "-h") {
+            options.help = true;
+        } else {
+            std::cerr << "Unknown or incomplete option: " << arg << "\n";
+            return false;
         }
     }
+    return true;
+}
+
+// Runs the requested transports until SIGINT/SIGTERM; each gets its own thread
+int runServers(const CommandLineOptions& options) {
+    AIEngine::AIEngineServer server;
+    server.start();
     
-private:
-    bool useNeuralGeneration(const CodeRequest& request) {
-        // Use neural network for complex requests
-        return request.prompt.length() > 50 || 
-               request.context.length() > 100;
-    }
-    
-    std::string generateWithNN(const CodeRequest& request) {
-        // Tokenize input
-        auto tokens = tokenizer->tokenize(request.prompt);
-        
-        // Convert to float vector (embedding simulation)
-        std::vector<float> input(512, 0.0f);
-        for (size_t i = 0; i < std::min(tokens.size(), input.size()); ++i) {
-            input[i] = static_cast<float>(tokens[i]) / 1000.0f;
-        }
-        
-        // Forward pass through neural network
-        auto output = model->forward(input);
-        
-        // Convert output back to tokens (simplified)
-        std::vector<int> output_tokens;
-        for (float val : output) {
-            if (val > 0.5f) {
-                output_tokens.push_back(static_cast<int>(val * 1000) % 100);
-            }
+    std::atomic<int> status{0};
+    try {
+        std::unique_ptr<AIEngine::DaemonServer> daemon;
+        std::unique_ptr<AIEngine::HttpServer> http;
+        std::unique_ptr<AIEngine::ShmServer> shm;
+        
+        if (options.daemon) {
+            daemon = std::make_unique<AIEngine::DaemonServer>(server, options.socket_path, options.workers,
+                                                            options.io_backend);
+            active_daemon.store(daemon.get());
+            std::cout << "Listening on " << options.socket_path << " (" << daemon->backendName() << ")\n";
         }
-        
-        // Detokenize and format
-        std::string raw_output = tokenizer->detokenize(output_tokens);
-        return formatGeneratedCode(raw_output, request.language);
-    }
-    
-    std::string generateWithTemplate(const CodeRequest& request) {
-        auto it = templates.find(request.language);
-        if (it == templates.end()) {
-            return "// Template not available for this language";
+        if (options.http_port > 0) {
+            http = std::make_unique<AIEngine::HttpServer>(server, options.http_host, options.http_port,
+                                                          options.workers, options.io_backend);
+            active_http.store(http.get());
+            std::cout << "Listening on http://" << options.http_host << ":" << options.http_port
+                      << " (" << http->backendName() << ")\n";
         }
-        
-        // Simple template selection based on prompt keywords
-        std::string template_code = it->second[0]; // Default to first template
-        
-        if (request.prompt.find("class") != std::string::npos) {
-            template_code = it->second[1];
+        if (!options.shm_name.empty()) {
+            shm = std::make_unique<AIEngine::ShmServer>(server, options.shm_name, options.workers);
+            active_shm.store(shm.get());
+            std::cout << "Serving shared memory channel " << options.shm_name << "\n";
         }
         
-        // Simple placeholder replacement
-        template_code = replacePlaceholders(template_code, request);
-        
-        return template_code;
-    }
-    
-    std::string replacePlaceholders(const std::string& template_str, const CodeRequest& request) {
-        std::string result = template_str;
-        
-        // Extract function name from prompt
-        std::string function_name = extractFunctionName(request.prompt);
-        
-        // Simple replacements
-        std::map<std::string, std::string> replacements = {
-            {"{function_name}", function_name},
-            {"{class_name}", capitalizeFirst(function_name)},
-            {"{description}", request.prompt},
-            {"{body}", generateFunctionBody(request)},
-            {"{params}", ""},
-            {"{return_type}", inferReturnType(request)},
-            {"{main_body}", "// TODO: Implement main logic"}
-        };
-        
-        for (const auto& pair : replacements) {
-            size_t pos = 0;
-            while ((pos = result.find(pair.first, pos)) != std::string::npos) {
-                result.replace(pos, pair.first.length(), pair.second);
-                pos += pair.second.length();
+        std::signal(SIGINT, handleStopSignal);
+        std::signal(SIGTERM, handleStopSignal);
+        std::signal(SIGHUP, handleReloadSignal);
+        std::cout << "Using " << options.workers << " worker threads per transport\n";
+        std::cout.flush();
+
+        // Swaps in a freshly loaded template directory on SIGHUP; requests
+        // already rendering keep the templates they started with
+        std::atomic<bool> servers_done{false};
+        std::thread reloader([&options, &servers_done]() {
+            while (!servers_done.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                if (!reload_requested.exchange(false) || options.templates_dir.empty()) continue;
+                try {
+                    size_t count = AIEngine::CodeGenerator::reloadTemplates(options.templates_dir);
+                    std::cout << "Reloaded " << count << " templates from " << options.templates_dir << "\n";
+                    std::cout.flush();
+                } catch (const std::exception& e) {
+                    std::cerr << "Template reload failed, keeping current templates: " << e.what() << "\n";
+                }
             }
-        }
-        
-        return result;
-    }
-    
-    std::string extractFunctionName(const std::string& prompt) {
-        // Simple extraction - look for verbs or action words
-        std::vector<std::string> action_words = {
-            "calculate", "compute", "find", "sort", "search", 
-            "create", "generate", "process", "convert", "parse"
+        });
+        
+        // A transport that fails stops the others, so the process exits as a whole
+        std::vector<std::thread> threads;
+        auto launch = [&threads, &status](auto* transport, const char* name) {
+            if (!transport) return;
+            threads.emplace_back([transport, name, &status]() {
+                try {
+                    transport->run();
+                } catch (const std::exception& e) {
+                    std::cerr << name << " error: " << e.what() << "\n";
+                    status.store(1);
+                    handleStopSignal(0);
+                }
+            });
         };
-        
-        std::string lower_prompt = prompt;
-        std::transform(lower_prompt.begin(), lower_prompt.end(), 
-                      lower_prompt.begin(), ::tolower);
-        
-        for (const auto& word : action_words) {
-            if (lower_prompt.find(word) != std::string::npos) {
-                return word + "_function";
-            }
+        launch(daemon.get(), "Daemon");
+        launch(http.get(), "HTTP server");
+        launch(shm.get(), "Shared memory server");
+        for (auto& thread : threads) {
+            thread.join();
         }
-        
-        return "generated_function";
+        servers_done.store(true);
+        reloader.join();
+        clearActiveServers();
+    } catch (const std::exception& e) {
+        clearActiveServers();
+        std::cerr << "Server error: " << e.what() << "\n";
+        status.store(1);
     }
     
-    std::string capitalizeFirst(const std::string& str) {
-        if (str.empty()) return str;
-        std::string result = str;
-        result[0] = std::toupper(result[0]);
-        return result;
-    }
-    
-    std::string generateFunctionBody(const CodeRequest& request) {
-        if (request.language == Language::PYTHON) {
-            return "    # TODO: Implement " + request.prompt + "\n    pass";
-        } else if (request.language == Language::CPP) {
-            return "    // TODO: Implement " + request.prompt + "\n    return 0;";
-        } else if (request.language == Language::JAVASCRIPT) {
-            return "    // TODO: Implement " + request.prompt + "\n    return null;";
-        }
-        return "    // TODO: Implement logic";
-    }
-    
-    std::string inferReturnType(const CodeRequest& request) {
-        std::string lower_prompt = request.prompt;
-        std::transform(lower_prompt.begin(), lower_prompt.end(), 
-                      lower_prompt.begin(), ::tolower);
-        
-        if (lower_prompt.find("count") != std::string::npos ||
-            lower_prompt.find("number") != std::string::npos ||
-            lower_prompt.find("calculate") != std::string::npos) {
-            return request.language == Language::CPP ? "int" : "number";
-        }
-        
-        if (lower_prompt.find("string") != std::string::npos ||
-            lower_prompt.find("text") != std::string::npos) {
-            return request.language == Language::CPP ? "string" : "string";
-        }
-        
-        return request.language == Language::CPP ? "auto" : "var";
-    }
-    
-    std::string formatGeneratedCode(const std::string& raw_code, Language lang) {
-        // Basic code formatting
-        std::string formatted = raw_code;
-        
-        // Remove extra whitespace
-        formatted = std::regex_replace(formatted, std::regex("\\s+"), " ");
-        
-        // Add proper indentation (simplified)
-        if (lang == Language::PYTHON) {
-            formatted = std::regex_replace(formatted, std::regex("def "), "\ndef ");
-            formatted = std::regex_replace(formatted, std::regex("class "), "\nclass ");
-        }
-        
-        return formatted;
+    server.stop();
+    if (options.stats) {
+        std::cerr << AIEngine::Metrics::formatReport(AIEngine::AIEngineServer::metrics());
     }
-};
+    return status.load();
+}
 
-class CodeAnalyzer {
-public:
-    struct AnalysisResult {
-        int lines_of_code;
-        int cyclomatic_complexity;
-        std::vector<std::string> functions;
-        std::vector<std::string> classes;
-        std::vector<std::string> issues;
-        float maintainability_index;
-    };
-    
-    AnalysisResult analyzeCode(const std::string& code, Language language) {
-        AnalysisResult result;
-        
-        result.lines_of_code = countLines(code);
-        result.cyclomatic_complexity = calculateComplexity(code, language);
-        result.functions = extractFunctions(code, language);
-        result.classes = extractClasses(code, language);
-        result.issues = findIssues(code, language);
-        result.maintainability_index = calculateMaintainability(result);
-        
-        return result;
-    }
-    
-private:
-    int countLines(const std::string& code) {
-        return std::count(code.begin(), code.end(), '\n') + 1;
-    }
+// Processes the request in a JSON file (an /api/generate body) and prints
+// the response as JSON
+int runRequestFile(const std::string& path) {
+    AIEngine::CodeRequest request;
+    bool stream = false;
+    std::string error;
     
-    int calculateComplexity(const std::string& code, Language language) {
-        int complexity = 1; // Base complexity
-        
-        // Count decision points
-        std::vector<std::string> decision_keywords;
-        
-        if (language == Language::CPP) {
-            decision_keywords = {"if", "else", "for", "while", "switch", "case", "catch"};
-        } else if (language == Language::PYTHON) {
-            decision_keywords = {"if", "elif", "else", "for", "while", "except", "and", "or"};
-        } else if (language == Language::JAVASCRIPT) {
-            decision_keywords = {"if", "else", "for", "while", "switch", "case", "catch"};
-        }
-        
-        for (const auto& keyword : decision_keywords) {
-            size_t pos = 0;
-            while ((pos = code.find(keyword, pos)) != std::string::npos) {
-                complexity++;
-                pos += keyword.length();
-            }
+    try {
+        std::string body = AIEngine::readFileContents(path);
+        if (!AIEngine::requestFromJson(body, AIEngine::RequestType::GENERATE_CODE, request, stream, error)) {
+            std::cerr << path << ": " << error << "\n";
+            return 1;
         }
-        
-        return complexity;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
     }
     
-    std::vector<std::string> extractFunctions(const std::string& code, Language language) {
-        std::vector<std::string> functions;
-        std::regex function_regex;
-        
-        if (language == Language::CPP) {
-            function_regex = std::regex(R"(\w+\s+(\w+)\s*\([^)]*\)\s*\{)");
-        } else if (language == Language::PYTHON) {
-            function_regex = std::regex(R"(def\s+(\w+)\s*\([^)]*\)\s*:)");
-        } else if (language == Language::JAVASCRIPT) {
-            function_regex = std::regex(R"(function\s+(\w+)\s*\([^)]*\)\s*\{)");
-        }
-        
-        std::sregex_iterator iter(code.begin(), code.end(), function_regex);
-        std::sregex_iterator end;
-        
-        for (; iter != end; ++iter) {
-            functions.push_back((*iter)[1].str());
-        }
-        
-        return functions;
-    }
+    // start()/stop() only announce the server on stdout, which here
+    // carries nothing but the JSON result
+    AIEngine::AIEngineServer server;
+    auto response = server.processRequest(request);
     
-    std::vector<std::string> extractClasses(const std::string& code, Language language) {
-        std::vector<std::string> classes;
-        std::regex class_regex;
-        
-        if (language == Language::CPP) {
-            class_regex = std::regex(R"(class\s+(\w+))");
-        } else if (language == Language::PYTHON) {
-            class_regex = std::regex(R"(class\s+(\w+))");
-        } else if (language == Language::JAVASCRIPT) {
-            class_regex = std::regex(R"(class\s+(\w+))");
-        }
-        
-        std::sregex_iterator iter(code.begin(), code.end(), class_regex);
-        std::sregex_iterator end;
-        
-        for (; iter != end; ++iter) {
-            classes.push_back((*iter)[1].str());
+    std::cout << AIEngine::responseToJson(response) << "\n";
+    return response.error.empty() ? 0 : 1;
+}
+
+// Processes one JSON request per input line on the worker pool and writes
+// one JSON response per line: in input order, or as soon as each finishes
+// with its zero-based input line number under "line". The number of
+// requests in flight is bounded so arbitrarily large inputs stream through.
+int runBatch(const CommandLineOptions& options) {
+    std::ifstream file;
+    if (options.batch_file != "-") {
+        file.open(options.batch_file, std::ios::binary);
+        if (!file) {
+            std::cerr << "Cannot open " << options.batch_file << "\n";
+            return 1;
         }
-        
-        return classes;
     }
-    
-    std::vector<std::string> findIssues(const std::string& code, Language language) {
-        std::vector<std::string> issues;
-        
-        // Check for common issues
-        if (code.find("TODO") != std::string::npos) {
-            issues.push_back("Contains TODO comments");
-        }
-        
-        if (code.find("FIXME") != std::string::npos) {
-            issues.push_back("Contains FIXME comments");
-        }
-        
-        // Language-specific checks
-        if (language == Language::CPP) {
-            if (code.find("using namespace std;") != std::string::npos) {
-                issues.push_back("Uses 'using namespace std' (not recommended)");
+    std::istream& input = options.batch_file == "-" ? std::cin : file;
+    std::ios::sync_with_stdio(false);
+    
+    AIEngine::AIEngineServer server;  // not start()ed: stdout is JSONL only
+    // The backlog below is deliberate; shedding to templates would only
+    // lower the quality of a batch nobody is waiting on per request
+    AIEngine::Router::shared().setLoadAware(false);
+    
+    std::mutex finished_mutex;
+    std::condition_variable finished_cv;
+    std::map<uint64_t, std::string> finished;
+    uint64_t submitted = 0;
+    uint64_t written = 0;
+    std::atomic<uint64_t> failures{0};
+    const uint64_t max_in_flight = options.workers * 64;
+    
+    // Writes whatever may be written now; with wait, blocks for at least one
+    auto drain = [&](bool wait) {
+        std::string out;
+        {
+            std::unique_lock<std::mutex> lock(finished_mutex);
+            auto ready = [&]() {
+                return !finished.empty() && (options.batch_unordered || finished.begin()->first == written);
+            };
+            if (wait) finished_cv.wait(lock, ready);
+            while (ready()) {
+                out += finished.begin()->second;
+                out += '\n';
+                finished.erase(finished.begin());
+                written++;
             }
         }
-        
-        return issues;
-    }
-    
-    float calculateMaintainability(const AnalysisResult& result) {
-        // Simplified maintainability index calculation
-        float base_score = 100.0f;
-        
-        // Penalize high complexity
-        base_score -= result.cyclomatic_complexity * 2.0f;
-        
-        // Penalize long files
-        if (result.lines_of_code > 500) {
-            base_score -= (result.lines_of_code - 500) * 0.1f;
-        }
-        
-        // Penalize issues
-        base_score -= result.issues.size() * 5.0f;
-        
-        return std::max(0.0f, std::min(100.0f, base_score));
-    }
-};
-
-class AIEngineServer {
-private:
-    std::unique_ptr<CodeGenerator> generator;
-    std::unique_ptr<CodeAnalyzer> analyzer;
-    std::mutex request_mutex;
-    std::queue<CodeRequest> request_queue;
-    bool running;
-    
-public:
-    AIEngineServer() : generator(std::make_unique<CodeGenerator>()),
-                      analyzer(std::make_unique<CodeAnalyzer>()),
-                      running(false) {}
-    
-    void start() {
-        running = true;
-        std::cout << "AI Engine Server (C++) started successfully\n";
-        std::cout << "Ready to process requests...\n";
-    }
-    
-    void stop() {
-        running = false;
-        std::cout << "AI Engine Server stopped\n";
-    }
-    
-    CodeResponse processRequest(const CodeRequest& request) {
-        std::lock_guard<std::mutex> lock(request_mutex);
-        
-        switch (request.type) {
-            case RequestType::GENERATE_CODE:
-                return generator->generateCode(request);
-                
-            case RequestType::ANALYZE_CODE:
-                return analyzeCodeRequest(request);
-                
-            default:
-                return CodeResponse{
-                    "",
-                    "Unsupported request type",
-                    0.0f,
-                    "",
-                    "Request type not implemented",
-                    std::chrono::milliseconds(0)
-                };
-        }
-    }
+        std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+    };
     
-private:
-    CodeResponse analyzeCodeRequest(const CodeRequest& request) {
-        auto start_time = std::chrono::high_resolution_clock::now();
+    {
+        AIEngine::WorkerPool pool(options.workers);
+        std::string line;
+        uint64_t line_number = 0;
         
-        try {
-            auto analysis = analyzer->analyzeCode(request.context, request.language);
+        for (; std::getline(input, line); ++line_number) {
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
             
-            std::stringstream result_stream;
-            result_stream << "Code Analysis Results:\n";
-            result_stream << "Lines of Code: " << analysis.lines_of_code << "\n";
-            result_stream << "Cyclomatic Complexity: " << analysis.cyclomatic_complexity << "\n";
-            result_stream << "Functions: " << analysis.functions.size() << "\n";
-            result_stream << "Classes: " << analysis.classes.size() << "\n";
-            result_stream << "Maintainability Index: " << analysis.maintainability_index << "\n";
+            while (submitted - written >= max_in_flight) drain(true);
             
-            if (!analysis.issues.empty()) {
-                result_stream << "Issues found:\n";
-                for (const auto& issue : analysis.issues) {
-                    result_stream << "- " << issue << "\n";
+            uint64_t slot = submitted++;
+            auto received_at = std::chrono::steady_clock::now();
+            pool.submit([&, slot, line_number, received_at, line = std::move(line)]() {
+                AIEngine::CodeRequest request;
+                request.received_at = received_at;
+                bool stream = false;
+                std::string error;
+                std::string json;
+                if (AIEngine::requestFromJson(line, AIEngine::RequestType::GENERATE_CODE, request, stream, error)) {
+                    AIEngine::CodeResponse response = server.processRequest(request);
+                    if (!response.error.empty()) failures++;
+                    json = AIEngine::responseToJson(response);
+                } else {
+                    failures++;
+                    json = AIEngine::errorToJson(error);
                 }
-            }
-            
-            auto end_time = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-            
-            return CodeResponse{
-                "",
-                result_stream.str(),
-                0.9f,
-                "",
-                "",
-                duration
-            };
-            
-        } catch (const std::exception& e) {
-            auto end_time = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-            
-            return CodeResponse{
-                "",
-                "Analysis failed",
-                0.0f,
-                "",
-                e.what(),
-                duration
-            };
+                if (options.batch_unordered) {
+                    json.insert(1, "\"line\":" + std::to_string(line_number) + ",");
+                }
+                
+                {
+                    std::lock_guard<std::mutex> lock(finished_mutex);
+                    finished.emplace(slot, std::move(json));
+                }
+                finished_cv.notify_one();
+            });
+            line.clear();
+            drain(false);
         }
+        
+        while (written < submitted) drain(true);
     }
-};
-
-// Utility functions
-Language stringToLanguage(const std::string& lang_str) {
-    std::string lower = lang_str;
-    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-    
-    if (lower == "python" || lower == "py") return Language::PYTHON;
-    if (lower == "cpp" || lower == "c++" || lower == "cxx") return Language::CPP;
-    if (lower == "javascript" || lower == "js") return Language::JAVASCRIPT;
-    if (lower == "html") return Language::HTML;
-    if (lower == "css") return Language::CSS;
     
-    return Language::UNKNOWN;
-}
-
-std::string languageToString(Language lang) {
-    switch (lang) {
-        case Language::PYTHON: return "Python";
-        case Language::CPP: return "C++";
-        case Language::JAVASCRIPT: return "JavaScript";
-        case Language::HTML: return "HTML";
-        case Language::CSS: return "CSS";
-        default: return "Unknown";
+    std::cout.flush();
+    std::cerr << "Processed " << submitted << " requests, " << failures.load() << " failed\n";
+    if (options.stats) {
+        std::cerr << AIEngine::Metrics::formatReport(AIEngine::AIEngineServer::metrics());
     }
+    return failures.load() == 0 ? 0 : 1;
 }
 
-} // namespace AIEngine
-
-// Main function for testing
-int main() {
+int runExample() {
     std::cout << "AI Engine - C++ Implementation\n";
     std::cout << "==============================\n\n";
     
@@ -794,4 +400,73 @@ int main() {
     
     server.stop();
     return 0;
-}
\ No newline at end of file
+}
+
+int runMode(const CommandLineOptions& options) {
+    if (options.daemon || options.http_port > 0 || !options.shm_name.empty()) {
+        return runServers(options);
+    }
+    
+    if (!options.request_file.empty()) {
+        return runRequestFile(options.request_file);
+    }
+    
+    if (!options.batch_file.empty()) {
+        return runBatch(options);
+    }
+    
+    return runExample();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CommandLineOptions options;
+    if (!parseCommandLine(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+    
+    if (options.help) {
+        printUsage(argv[0]);
+        return 0;
+    }
+    
+    if (!options.trace_file.empty()) {
+        AIEngine::Trace::setEnabled(true);
+    }
+    try {
+        if (!options.snapshot_file.empty()) {
+            AIEngine::Snapshot::restore(options.snapshot_file);
+        }
+        if (!options.templates_dir.empty()) {
+            size_t count = AIEngine::CodeGenerator::reloadTemplates(options.templates_dir);
+            std::cerr << "Loaded " << count << " templates from " << options.templates_dir << "\n";
+        }
+        if (!options.save_snapshot_file.empty()) {
+            AIEngine::Snapshot::save(options.save_snapshot_file);
+            std::cout << "Saved engine snapshot to " << options.save_snapshot_file << "\n";
+            return 0;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    if (options.perf_counters) {
+        std::string error;
+        if (!AIEngine::Metrics::enableHardwareCounters(error)) {
+            std::cerr << "Hardware counters unavailable, continuing without them: " << error << "\n";
+        }
+    }
+    int status = runMode(options);
+    
+    if (!options.trace_file.empty()) {
+        std::ofstream trace(options.trace_file, std::ios::binary);
+        trace << AIEngine::Trace::exportChrome();
+        if (!trace) {
+            std::cerr << "Cannot write trace to " << options.trace_file << "\n";
+            return status == 0 ? 1 : status;
+        }
+    }
+    return status;
+}
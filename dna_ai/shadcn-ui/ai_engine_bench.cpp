@@ -0,0 +1,886 @@
+/*
+AI Engine - Microbenchmarks
+Measures the engine's hot paths in isolation: tokenizer, neural network
+forward pass (single, batched and shallow), routing, code generation on
+the template and neural paths, constrained decoding, code analysis on
+small, medium and huge inputs, and startup: building each shared
+component, mapping them from a snapshot instead, and bringing up one more
+engine instance.
+
+Build and run with `make bench`, or directly:
+
+    ./build/ai_engine_bench [--filter SUBSTRING] [--samples N]
+                            [--min-time MS] [--json FILE]
+
+Each benchmark is warmed up, then its iteration count is calibrated so one
+sample takes at least --min-time; the report gives the median ns/op over
+all samples with the median absolute deviation, throughput, and heap
+allocations per op. --json writes every sample so that runs before and
+after a change can be compared statistically.
+
+decode/check is not timed: it runs grammar-constrained decodes for C++
+and JavaScript through an independent parser and exits with status 1 if
+any output is not valid code.
+*/
+
+#include "ai_engine/ai_engine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+// Heap allocation counters, fed by the global operator new below. The
+// replacements are kept out of line: once inlined, GCC pairs malloc with
+// operator delete and warns about a mismatch that cannot happen.
+namespace {
+std::atomic<uint64_t> allocation_count{0};
+std::atomic<uint64_t> allocation_bytes{0};
+}
+
+__attribute__((noinline)) void* operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) return memory;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+__attribute__((noinline)) void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Keeps the optimizer from discarding a benchmark's result
+template<typename T>
+void doNotOptimize(const T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+struct Options {
+    std::string filter;
+    size_t samples = 15;
+    double min_sample_ms = 20.0;
+    std::string json_file;
+};
+
+struct Result {
+    std::string name;
+    std::vector<double> ns_per_op;   // one entry per sample
+    double median = 0.0;
+    double mad = 0.0;                // median absolute deviation
+    double bytes_per_op = 0.0;       // input bytes processed, for throughput
+    double allocations_per_op = 0.0;
+    double allocated_bytes_per_op = 0.0;
+};
+
+double median(std::vector<double> values) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2.0;
+}
+
+template<typename Body>
+double timeIterations(Body& body, uint64_t iterations) {
+    auto start = Clock::now();
+    for (uint64_t i = 0; i < iterations; ++i) {
+        body();
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+template<typename Body>
+Result measure(const Options& options, const std::string& name, double bytes_per_op, Body body) {
+    Result result;
+    result.name = name;
+    result.bytes_per_op = bytes_per_op;
+
+    // Warm up caches, branch predictors and lazily built state
+    auto warmup_end = Clock::now() + std::chrono::milliseconds(50);
+    uint64_t iterations = 1;
+    while (Clock::now() < warmup_end) {
+        body();
+    }
+
+    // Grow the iteration count until one sample lasts min_sample_ms
+    double min_sample_ns = options.min_sample_ms * 1e6;
+    while (true) {
+        double elapsed = timeIterations(body, iterations);
+        if (elapsed >= min_sample_ns) break;
+        double scale = elapsed > 0 ? min_sample_ns / elapsed * 1.2 : 10.0;
+        iterations = std::max(iterations + 1, static_cast<uint64_t>(iterations * std::min(scale, 10.0)));
+    }
+
+    uint64_t allocations_before = allocation_count.load();
+    uint64_t bytes_before = allocation_bytes.load();
+    for (size_t sample = 0; sample < options.samples; ++sample) {
+        result.ns_per_op.push_back(timeIterations(body, iterations) / static_cast<double>(iterations));
+    }
+    double total_ops = static_cast<double>(iterations * options.samples);
+    result.allocations_per_op = static_cast<double>(allocation_count.load() - allocations_before) / total_ops;
+    result.allocated_bytes_per_op = static_cast<double>(allocation_bytes.load() - bytes_before) / total_ops;
+
+    result.median = median(result.ns_per_op);
+    std::vector<double> deviations;
+    for (double value : result.ns_per_op) {
+        deviations.push_back(std::fabs(value - result.median));
+    }
+    result.mad = median(deviations);
+    return result;
+}
+
+std::string formatDuration(double nanoseconds) {
+    char buffer[32];
+    if (nanoseconds < 1e3) std::snprintf(buffer, sizeof(buffer), "%.1f ns", nanoseconds);
+    else if (nanoseconds < 1e6) std::snprintf(buffer, sizeof(buffer), "%.2f us", nanoseconds / 1e3);
+    else std::snprintf(buffer, sizeof(buffer), "%.2f ms", nanoseconds / 1e6);
+    return buffer;
+}
+
+void printResult(const Result& result) {
+    char line[256];
+    double ops_per_second = result.median > 0 ? 1e9 / result.median : 0.0;
+    std::snprintf(line, sizeof(line), "%-34s %12s  +-%5.1f%%  %12.0f op/s", result.name.c_str(),
+                  formatDuration(result.median).c_str(),
+                  result.median > 0 ? 100.0 * result.mad / result.median : 0.0, ops_per_second);
+    std::cout << line;
+
+    if (result.bytes_per_op > 0) {
+        std::snprintf(line, sizeof(line), "  %8.1f MB/s", result.bytes_per_op * ops_per_second / 1e6);
+        std::cout << line;
+    } else {
+        std::cout << "              ";
+    }
+    std::snprintf(line, sizeof(line), "  %8.1f allocs/op  %10.0f B/op\n", result.allocations_per_op,
+                  result.allocated_bytes_per_op);
+    std::cout << line;
+}
+
+void writeJson(const std::string& path, const std::vector<Result>& results) {
+    std::string out = "{\"benchmarks\":[";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        if (i > 0) out += ",";
+        out += "\n{\"name\":";
+        AIEngine::Json::appendString(out, result.name);
+        out += ",\"median_ns\":" + std::to_string(result.median);
+        out += ",\"mad_ns\":" + std::to_string(result.mad);
+        out += ",\"bytes_per_op\":" + std::to_string(result.bytes_per_op);
+        out += ",\"allocs_per_op\":" + std::to_string(result.allocations_per_op);
+        out += ",\"alloc_bytes_per_op\":" + std::to_string(result.allocated_bytes_per_op);
+        out += ",\"samples_ns\":[";
+        for (size_t j = 0; j < result.ns_per_op.size(); ++j) {
+            if (j > 0) out += ",";
+            out += std::to_string(result.ns_per_op[j]);
+        }
+        out += "]}";
+    }
+    out += "\n]}\n";
+
+    std::ofstream file(path, std::ios::binary);
+    file << out;
+    if (!file) {
+        throw std::runtime_error("Cannot write " + path);
+    }
+}
+
+// Source code resembling real inputs, repeated to the requested line count
+std::string makeSource(size_t lines) {
+    static const char* const kLines[] = {
+        "def process_items(items, limit):",
+        "    result = []",
+        "    for item in items:",
+        "        if item.value > limit and item.enabled:",
+        "            result.append(item)",
+        "        elif item.value == limit or item.pinned:",
+        "            continue",
+        "    # TODO: handle empty input",
+        "    return result",
+        "",
+        "class ItemStore:",
+        "    def __init__(self, backend):",
+        "        self.backend = backend",
+        "    def load(self, key):",
+        "        while not self.backend.ready():",
+        "            self.backend.wait()",
+        "        return self.backend.get(key)",
+    };
+    constexpr size_t kCount = sizeof(kLines) / sizeof(kLines[0]);
+
+    std::string source;
+    for (size_t i = 0; i < lines; ++i) {
+        source += kLines[i % kCount];
+        source += '\n';
+    }
+    return source;
+}
+
+// An independent recursive descent check of decoded C++ and JavaScript
+// token sequences, to hold the grammar to actual syntax rather than to
+// balanced brackets. Output is a fragment, so the top level takes both
+// statements and declarations.
+class SyntaxCheck {
+public:
+    SyntaxCheck(AIEngine::Language language, const std::vector<std::string>& tokens)
+        : cpp(language == AIEngine::Language::CPP), tokens(tokens) {}
+
+    bool valid() {
+        try {
+            while (!atEnd()) item(Scope::TOP);
+            return true;
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+    }
+
+private:
+    enum class Scope { TOP, BLOCK, MEMBERS, NAMESPACE };
+
+    bool cpp;
+    const std::vector<std::string>& tokens;
+    size_t at = 0;
+
+    bool atEnd() const { return at == tokens.size(); }
+    const std::string& peek() const {
+        static const std::string kEnd;
+        return atEnd() ? kEnd : tokens[at];
+    }
+    bool accept(const char* token) {
+        if (peek() != token) return false;
+        ++at;
+        return true;
+    }
+    void expect(const char* token) {
+        if (!accept(token)) fail();
+    }
+    [[noreturn]] void fail() const { throw std::runtime_error("syntax"); }
+
+    bool isKeyword(const std::string& token) const {
+        static const char* const kCpp[] = {"if", "else", "for", "while", "return", "class", "struct", "const",
+                                           "using", "namespace", "#include", "int", "float", "bool", "void",
+                                           "string", "switch"};
+        static const char* const kJavaScript[] = {"if", "else", "for", "while", "return", "class", "const",
+                                                  "function", "var", "let", "void", "#include", "using",
+                                                  "namespace", "def"};
+        if (cpp) return std::find(std::begin(kCpp), std::end(kCpp), token) != std::end(kCpp);
+        return std::find(std::begin(kJavaScript), std::end(kJavaScript), token) != std::end(kJavaScript);
+    }
+    bool isName(const std::string& token) const {
+        return !token.empty() && (std::isalpha(static_cast<unsigned char>(token[0])) || token[0] == '_') &&
+               !isKeyword(token);
+    }
+    void name() {
+        if (!isName(peek())) fail();
+        ++at;
+    }
+    bool isType(const std::string& token) const {
+        return cpp && (token == "int" || token == "float" || token == "bool" || token == "void" || token == "string");
+    }
+
+    void item(Scope scope) {
+        if (scope == Scope::TOP && cpp && accept("#include")) {
+            // One header, and the line ends there
+            name();
+            if (peek() == ";") fail();
+            return;
+        }
+        if (scope == Scope::NAMESPACE && accept(";")) return;
+        if (scope == Scope::MEMBERS) {
+            member();
+        } else if (!declaration(scope)) {
+            if (scope == Scope::NAMESPACE) fail();
+            statement();
+        }
+    }
+
+    // Whatever may only appear in a list of statements or declarations
+    bool declaration(Scope scope) {
+        if (accept("class") || (cpp && accept("struct"))) {
+            classBody();
+        } else if (cpp && peek() == "namespace" && scope != Scope::BLOCK) {
+            ++at;
+            name();
+            expect("{");
+            while (!accept("}")) {
+                if (atEnd()) fail();
+                item(Scope::NAMESPACE);
+            }
+        } else if (cpp && accept("using")) {
+            expect("namespace");
+            name();
+            expect(";");
+        } else if (cpp && (isType(peek()) || peek() == "const")) {
+            specifiers();
+            name();
+            if (scope != Scope::BLOCK && accept("(")) {
+                functionRest();
+            } else {
+                declaratorsRest();
+            }
+        } else if (!cpp && (peek() == "var" || peek() == "let" || peek() == "const")) {
+            bindings();
+            end();
+        } else if (!cpp && accept("function")) {
+            name();
+            expect("(");
+            functionRest();
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    void member() {
+        if (accept(";")) return;
+        if (cpp) {
+            if (accept("class") || accept("struct")) {
+                classBody();
+                return;
+            }
+            specifiers();
+            name();
+            if (accept("(")) {
+                functionRest();
+            } else {
+                declaratorsRest();
+            }
+        } else {
+            name();
+            expect("(");
+            functionRest();
+        }
+    }
+
+    void classBody() {
+        name();
+        if (cpp && accept(";")) return;
+        expect("{");
+        while (!accept("}")) {
+            if (atEnd()) fail();
+            member();
+        }
+        if (cpp) expect(";");
+    }
+
+    // At most one const and exactly one type
+    void specifiers() {
+        bool qualified = false;
+        bool typed = false;
+        for (;;) {
+            if (peek() == "const" && !qualified) {
+                qualified = true;
+            } else if (isType(peek()) && !typed) {
+                typed = true;
+            } else {
+                break;
+            }
+            ++at;
+        }
+        if (!typed) fail();
+    }
+
+    // After the name and '(': the parameters, then a body or, in C++, ';'
+    void functionRest() {
+        if (!accept(")")) {
+            do {
+                if (cpp) {
+                    specifiers();
+                    if (isName(peek())) ++at;
+                } else {
+                    name();
+                }
+            } while (accept(","));
+            expect(")");
+        }
+        if (cpp && accept(";")) return;
+        block();
+    }
+
+    void declaratorsRest() {
+        for (;;) {
+            if (accept("=")) assignment();
+            if (!accept(",")) break;
+            name();
+        }
+        expect(";");
+    }
+
+    void bindings() {
+        bool constant = peek() == "const";
+        ++at;
+        do {
+            name();
+            if (accept("=")) {
+                assignment();
+            } else if (constant) {
+                fail();
+            }
+        } while (accept(","));
+    }
+
+    void block() {
+        expect("{");
+        while (!accept("}")) {
+            if (atEnd()) fail();
+            item(Scope::BLOCK);
+        }
+    }
+
+    // The end of a JavaScript statement may be left to semicolon insertion
+    // before '}' or the end of input
+    void end() {
+        if (accept(";")) return;
+        if (cpp || !(atEnd() || peek() == "}")) fail();
+    }
+
+    void statement() {
+        if (accept(";")) return;
+        if (peek() == "{") {
+            block();
+        } else if (accept("if")) {
+            condition();
+            statement();
+            if (accept("else")) statement();
+        } else if (accept("while") || (cpp && accept("switch"))) {
+            condition();
+            statement();
+        } else if (accept("for")) {
+            forHeader();
+            statement();
+        } else if (accept("return")) {
+            expression();
+            end();
+        } else {
+            expression();
+            end();
+        }
+    }
+
+    void condition() {
+        expect("(");
+        expression();
+        expect(")");
+    }
+
+    void forHeader() {
+        expect("(");
+        if (!accept(";")) {
+            if (cpp && (isType(peek()) || peek() == "const")) {
+                specifiers();
+                name();
+                if (accept(":")) {
+                    expression();
+                    expect(")");
+                    return;
+                }
+                declaratorsRest();
+            } else if (!cpp && (peek() == "var" || peek() == "let" || peek() == "const")) {
+                bindings();
+                expect(";");
+            } else {
+                expression();
+                expect(";");
+            }
+        }
+        if (peek() != ";") expression();
+        expect(";");
+        if (peek() != ")") expression();
+        expect(")");
+    }
+
+    void expression() {
+        do {
+            assignment();
+        } while (accept(","));
+    }
+
+    // JavaScript assigns only to names, members and subscripts
+    void assignment() {
+        bool target = unary();
+        while (isBinary(peek())) {
+            ++at;
+            unary();
+            target = false;
+        }
+        if (accept("=")) {
+            if (!cpp && !target) fail();
+            assignment();
+        }
+    }
+
+    bool isBinary(const std::string& token) const {
+        static const char* const kOperators[] = {"+", "-", "*", "/", "==", "!=", "<", ">", "<=", ">="};
+        return std::find(std::begin(kOperators), std::end(kOperators), token) != std::end(kOperators);
+    }
+
+    // Whether the operand may be assigned to
+    bool unary() {
+        if (accept("+") || accept("-") || (!cpp && accept("void"))) {
+            unary();
+            return false;
+        }
+        bool target = primary();
+        for (;;) {
+            if (accept("(")) {
+                if (!accept(")")) {
+                    do {
+                        assignment();
+                    } while (accept(","));
+                    expect(")");
+                }
+                target = false;
+            } else if (accept("[")) {
+                if (cpp) {
+                    assignment();
+                } else {
+                    expression();
+                }
+                expect("]");
+                target = true;
+            } else if (accept(".")) {
+                name();
+                target = true;
+            } else {
+                return target;
+            }
+        }
+    }
+
+    bool primary() {
+        if (accept("(")) {
+            expression();
+            expect(")");
+            return false;
+        }
+        if (!cpp && accept("[")) {
+            if (!accept("]")) {
+                do {
+                    assignment();
+                } while (accept(","));
+                expect("]");
+            }
+            return false;
+        }
+        name();
+        return true;
+    }
+};
+
+// Decodes the shortest path to every state of the language's grammar and
+// a sample of random proposals, and reports how many outputs SyntaxCheck
+// rejects
+size_t checkDecodes(AIEngine::Language language, const std::vector<std::string>& vocabulary) {
+    const AIEngine::TokenGrammar grammar(language, vocabulary);
+    std::vector<std::vector<int>> paths(grammar.stateCount());
+    std::vector<bool> seen(grammar.stateCount());
+    std::vector<uint32_t> queue{AIEngine::TokenGrammar::start()};
+    seen[queue.front()] = true;
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const uint32_t state = queue[head];
+        for (size_t token = 0; token < vocabulary.size(); ++token) {
+            const int id = static_cast<int>(token);
+            if (!grammar.valid(state, id)) continue;
+            const uint32_t target = grammar.advance(state, id);
+            if (seen[target]) continue;
+            seen[target] = true;
+            paths[target] = paths[state];
+            paths[target].push_back(id);
+            queue.push_back(target);
+        }
+    }
+
+    constexpr size_t kSamples = 2000;
+    std::mt19937 random(1);
+    for (size_t i = 0; i < kSamples; ++i) {
+        std::vector<int> proposals(1 + random() % 64);
+        for (int& proposal : proposals) proposal = static_cast<int>(random() % 100);
+        paths.push_back(std::move(proposals));
+    }
+
+    size_t invalid = 0;
+    std::string first;
+    for (const auto& proposals : paths) {
+        std::vector<std::string> words;
+        for (int token : grammar.decode(proposals)) words.push_back(vocabulary[static_cast<size_t>(token)]);
+        if (SyntaxCheck(language, words).valid()) continue;
+        if (invalid++ == 0) {
+            for (const auto& word : words) first += " " + word;
+        }
+    }
+    std::cout << "  decode/check " << AIEngine::languageToString(language) << ": " << queue.size() << " states, "
+              << kSamples << " samples, " << invalid << " invalid" << (invalid ? ", first:" + first : "") << "\n";
+    return invalid;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--samples" && i + 1 < argc) {
+            options.samples = static_cast<size_t>(std::max(3, std::atoi(argv[++i])));
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            options.min_sample_ms = std::max(1.0, std::atof(argv[++i]));
+        } else if (arg == "--json" && i + 1 < argc) {
+            options.json_file = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--filter SUBSTRING] [--samples N] [--min-time MS] [--json FILE]\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 2;
+    }
+
+    std::cout << "kernels: " << AIEngine::Kernels::isaLevel() << "\n";
+    std::vector<Result> results;
+    auto run = [&](const std::string& name, double bytes_per_op, auto body) {
+        if (!options.filter.empty() && name.find(options.filter) == std::string::npos) return;
+        results.push_back(measure(options, name, bytes_per_op, body));
+        printResult(results.back());
+    };
+
+    AIEngine::TokenProcessor tokenizer;
+    const std::string prompt = "create a function to calculate fibonacci numbers using a for loop "
+                               "and return the int result ; if ( n <= 1 ) return n ;";
+    const std::vector<int> tokens = tokenizer.tokenize(prompt);
+
+    run("tokenize/prompt", static_cast<double>(prompt.size()), [&]() {
+        doNotOptimize(tokenizer.tokenize(prompt));
+    });
+    run("detokenize/prompt", 0, [&]() {
+        doNotOptimize(tokenizer.detokenize(tokens));
+    });
+
+    AIEngine::NeuralNetwork network;
+    std::vector<float> input(512);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = static_cast<float>(i % 97) / 1000.0f;
+    }
+    run("forward/single", 0, [&]() {
+        doNotOptimize(network.forward(input));
+    });
+    run("forward/shallow", 0, [&]() {
+        doNotOptimize(network.forwardShallow(input));
+    });
+    for (size_t batch : {8, 32}) {
+        std::vector<std::vector<float>> inputs(batch, input);
+        // Reported per input so it compares directly with forward/single
+        std::string name = "forward/batch" + std::to_string(batch);
+        if (!options.filter.empty() && name.find(options.filter) == std::string::npos) continue;
+        Result result = measure(options, name, 0, [&]() {
+            doNotOptimize(network.forwardBatch(inputs));
+        });
+        for (double& value : result.ns_per_op) value /= static_cast<double>(batch);
+        result.median /= static_cast<double>(batch);
+        result.mad /= static_cast<double>(batch);
+        result.allocations_per_op /= static_cast<double>(batch);
+        result.allocated_bytes_per_op /= static_cast<double>(batch);
+        results.push_back(result);
+        printResult(result);
+    }
+
+    run("prompt/analyze", static_cast<double>(prompt.size()), [&]() {
+        doNotOptimize(AIEngine::analyzePrompt(prompt));
+    });
+
+    // Routing decision alone, idle and with most workers busy
+    {
+        AIEngine::Router router;
+        AIEngine::CodeRequest route_request;
+        route_request.prompt = prompt;
+        const AIEngine::PromptFeatures features = AIEngine::analyzePrompt(prompt);
+        for (double load : {0.0, 0.9}) {
+            run(load == 0.0 ? "route/idle" : "route/loaded", 0, [&]() {
+                doNotOptimize(router.route(route_request, features, load));
+            });
+        }
+
+        // Prompt and context sizes across the load range, with the seed
+        // costs: each path should own some band of it
+        std::vector<std::pair<AIEngine::CodeRequest, AIEngine::PromptFeatures>> sweep;
+        for (size_t length : {20, 60, 120, 200, 300}) {
+            for (size_t context : {0, 400}) {
+                AIEngine::CodeRequest request;
+                request.prompt = "sort " + std::string(length, 'x');
+                request.context = std::string(context, 'y');
+                sweep.emplace_back(request, AIEngine::analyzePrompt(request.prompt));
+            }
+        }
+        auto routeSweep = [&](AIEngine::Router& target) {
+            for (const auto& entry : sweep) {
+                for (int step = 0; step < 20; ++step) {
+                    doNotOptimize(target.route(entry.first, entry.second, step / 20.0));
+                }
+            }
+        };
+        AIEngine::Router counting;
+        routeSweep(counting);
+        run("route/sweep200", 0, [&]() { routeSweep(router); });
+        if (options.filter.empty() || std::string("route/sweep200").find(options.filter) != std::string::npos) {
+            std::cout << "  route/sweep200 paths: template "
+                      << counting.routedCount(AIEngine::GenerationPath::TEMPLATE) << ", small_network "
+                      << counting.routedCount(AIEngine::GenerationPath::SMALL_NETWORK) << ", large_network "
+                      << counting.routedCount(AIEngine::GenerationPath::LARGE_NETWORK) << "\n";
+        }
+    }
+
+    AIEngine::CodeGenerator generator;
+    AIEngine::CodeRequest template_request;
+    template_request.prompt = "sort a list";
+    template_request.language = AIEngine::Language::PYTHON;
+    run("generate/template", 0, [&]() {
+        doNotOptimize(generator.generateCode(template_request));
+    });
+
+    // Template retrieval from a library of the size we maintain
+    {
+        static const char* const kWords[] = {
+            "sort", "search", "parse", "http", "client", "cache", "queue", "tree", "graph", "matrix",
+            "json", "csv", "file", "reader", "writer", "socket", "server", "retry", "config", "logger",
+            "stack", "heap", "hash", "map", "string", "date", "token", "stream", "batch", "worker"
+        };
+        constexpr size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+        AIEngine::TemplateLibrary library;
+        for (size_t i = 0; i < 512; ++i) {
+            std::string name = std::string(kWords[i % kWordCount]) + "_" + kWords[(i / kWordCount + i) % kWordCount] +
+                               "_" + std::to_string(i);
+            library.add(AIEngine::Language::PYTHON, name, "def {function_name}({params}):\n    \"\"\"" + name +
+                        " {description}\"\"\"\n{body}\n");
+        }
+        const std::string select_prompt = "parse a json config file";
+        run("templates/select512", static_cast<double>(select_prompt.size()), [&]() {
+            doNotOptimize(library.select(AIEngine::Language::PYTHON, select_prompt));
+        });
+    }
+
+    // Prompts over 50 characters take the neural network path
+    AIEngine::CodeRequest nn_request;
+    nn_request.prompt = prompt;
+    nn_request.language = AIEngine::Language::CPP;
+    run("generate/nn", 0, [&]() {
+        doNotOptimize(generator.generateCode(nn_request));
+    });
+
+    // Grammar-constrained decoding of as many steps as a forward pass
+    // typically proposes, most of them out of place
+    const std::vector<std::string> vocabulary = tokenizer.vocabulary();
+    AIEngine::TokenGrammar grammar(AIEngine::Language::CPP, vocabulary);
+    std::vector<int> proposals(256);
+    for (size_t i = 0; i < proposals.size(); ++i) {
+        proposals[i] = static_cast<int>((i * 37) % 100);
+    }
+    run("decode/constrained", 0, [&]() {
+        doNotOptimize(grammar.decode(proposals));
+    });
+    size_t invalid_decodes = 0;
+    if (options.filter.empty() || std::string("decode/check").find(options.filter) != std::string::npos) {
+        for (AIEngine::Language language : {AIEngine::Language::CPP, AIEngine::Language::JAVASCRIPT}) {
+            invalid_decodes += checkDecodes(language, vocabulary);
+        }
+    }
+
+    AIEngine::CodeAnalyzer analyzer;
+    const std::pair<const char*, size_t> sizes[] = {{"small", 20}, {"medium", 1000}, {"huge", 20000}};
+    for (const auto& size : sizes) {
+        std::string source = makeSource(size.second);
+        run(std::string("analyze/") + size.first, static_cast<double>(source.size()), [&]() {
+            doNotOptimize(analyzer.analyzeCode(source, AIEngine::Language::PYTHON));
+        });
+    }
+
+    // Cold start: what the first request of a new process pays for each
+    // shared component, and what every further engine instance costs once
+    // they exist (construction plus a first template and analysis request)
+    run("startup/tokenizer", 0, []() {
+        doNotOptimize(AIEngine::TokenProcessor());
+    });
+    run("startup/network", 0, []() {
+        doNotOptimize(AIEngine::NeuralNetwork());
+    });
+    run("startup/grammar", 0, [&]() {
+        doNotOptimize(AIEngine::TokenGrammar(AIEngine::Language::CPP, vocabulary));
+    });
+    run("startup/templates", 0, []() {
+        doNotOptimize(AIEngine::CodeGenerator::initializeTemplates());
+    });
+    if (options.filter.empty() || std::string("startup/snapshot").find(options.filter) != std::string::npos) {
+        std::string snapshot = "/tmp/ai_engine_bench." + std::to_string(::getpid()) + ".snapshot";
+        AIEngine::Snapshot::save(snapshot);
+        run("startup/snapshot", 0, [&]() {
+            doNotOptimize(AIEngine::Snapshot::load(snapshot));
+        });
+        std::remove(snapshot.c_str());
+    }
+    AIEngine::CodeRequest analyze_request;
+    analyze_request.type = AIEngine::RequestType::ANALYZE_CODE;
+    analyze_request.context = makeSource(20);
+    analyze_request.language = AIEngine::Language::PYTHON;
+    run("startup/server", 0, [&]() {
+        AIEngine::AIEngineServer server;
+        doNotOptimize(server.processRequest(template_request));
+        doNotOptimize(server.processRequest(analyze_request));
+    });
+
+    // Request decoding is dominated by scanning the escaped context string
+    std::string body = "{\"prompt\":\"sort a list\",\"language\":\"python\",\"context\":";
+    AIEngine::Json::appendString(body, makeSource(2000));
+    body += "}";
+    run("json/request", static_cast<double>(body.size()), [&]() {
+        AIEngine::CodeRequest request;
+        bool stream = false;
+        std::string error;
+        doNotOptimize(AIEngine::requestFromJson(body, AIEngine::RequestType::GENERATE_CODE, request, stream,
+                                                error));
+        doNotOptimize(request);
+    });
+
+    if (!options.json_file.empty()) {
+        try {
+            writeJson(options.json_file, results);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+    return invalid_decodes ? 1 : 0;
+}
@@ -0,0 +1,602 @@
+/*
+AI Engine - Load Generator
+Drives the engine end to end with a request mix drawn from a corpus and
+reports throughput and latency percentiles against an optional SLO.
+
+Targets:
+    inproc                  AIEngineServer in this process
+    unix:/tmp/ai_engine.sock  a daemon started with --daemon
+    http://127.0.0.1:8080   the built-in HTTP server (--http)
+    shm:/ai_engine          a shared memory channel (--shm)
+
+Closed loop (default): --connections clients each send their next request
+as soon as the previous one is answered. Open loop: --rate R schedules R
+requests per second (Poisson arrivals with --poisson) regardless of how
+fast the engine answers. Open-loop latency is measured from each request's
+scheduled send time, so time a request spent waiting for a free connection
+counts against it and stalls are not hidden (coordinated omission); the
+uncorrected service time is reported alongside.
+
+The corpus is a JSONL file in the /api/generate body format (with an
+optional "type" and "weight" per line); without one a built-in mix of
+template, neural network and analysis requests is used.
+
+    ./build/ai_engine_loadgen --target http://127.0.0.1:8080 --rate 2000 \
+        --duration 30 --corpus requests.jsonl --slo-p99 5
+*/
+
+#include "ai_engine/ai_engine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string target = "inproc";
+    std::string corpus_file;
+    size_t connections = 16;
+    double rate = 0.0;            // requests per second; 0 selects closed loop
+    bool poisson = false;
+    double duration_seconds = 10.0;
+    double warmup_seconds = 1.0;
+    double slo_p99_ms = 0.0;
+    uint64_t seed = 42;
+};
+
+struct CorpusEntry {
+    AIEngine::CodeRequest request;
+    std::string http_body;        // request re-encoded as an /api body
+    std::string wire_frame;       // request encoded for the daemon
+    double weight = 1.0;
+};
+
+// Picks corpus entries in proportion to their weights
+class Corpus {
+private:
+    std::vector<CorpusEntry> entries;
+    std::vector<double> cumulative;
+
+public:
+    void add(CorpusEntry entry) {
+        double total = cumulative.empty() ? 0.0 : cumulative.back();
+        cumulative.push_back(total + std::max(0.0, entry.weight));
+        entries.push_back(std::move(entry));
+    }
+
+    bool empty() const { return entries.empty() || cumulative.back() <= 0.0; }
+    size_t size() const { return entries.size(); }
+
+    const CorpusEntry& pick(std::mt19937_64& random) const {
+        std::uniform_real_distribution<double> distribution(0.0, cumulative.back());
+        double point = distribution(random);
+        size_t index = static_cast<size_t>(std::upper_bound(cumulative.begin(), cumulative.end(), point) -
+                                           cumulative.begin());
+        return entries[std::min(index, entries.size() - 1)];
+    }
+};
+
+std::string requestToJson(const AIEngine::CodeRequest& request) {
+    std::string body = "{\"language\":";
+    std::string language = AIEngine::languageToString(request.language);
+    std::transform(language.begin(), language.end(), language.begin(), ::tolower);
+    AIEngine::Json::appendString(body, language);
+
+    if (request.type == AIEngine::RequestType::ANALYZE_CODE) {
+        body += ",\"code\":";
+        AIEngine::Json::appendString(body, request.context);
+    } else {
+        body += ",\"prompt\":";
+        AIEngine::Json::appendString(body, request.prompt);
+        body += ",\"context\":";
+        AIEngine::Json::appendString(body, request.context);
+        body += ",\"max_tokens\":" + std::to_string(request.max_tokens);
+        body += ",\"temperature\":" + std::to_string(request.temperature);
+    }
+    body += "}";
+    return body;
+}
+
+void addEntry(Corpus& corpus, AIEngine::CodeRequest request, double weight) {
+    CorpusEntry entry;
+    entry.http_body = requestToJson(request);
+    AIEngine::Wire::encodeRequest(0, request, entry.wire_frame);
+    entry.request = std::move(request);
+    entry.weight = weight;
+    corpus.add(std::move(entry));
+}
+
+Corpus loadCorpus(const std::string& path) {
+    Corpus corpus;
+
+    if (path.empty()) {
+        AIEngine::CodeRequest request;
+        request.prompt = "sort a list";
+        request.language = AIEngine::Language::PYTHON;
+        addEntry(corpus, request, 5.0);
+
+        request.prompt = "create a class to manage user sessions with expiry and a function to refresh them";
+        request.language = AIEngine::Language::CPP;
+        addEntry(corpus, request, 3.0);
+
+        request = AIEngine::CodeRequest();
+        request.type = AIEngine::RequestType::ANALYZE_CODE;
+        request.language = AIEngine::Language::PYTHON;
+        for (int i = 0; i < 40; ++i) {
+            request.context += "def f" + std::to_string(i) + "(x):\n    if x > " + std::to_string(i) +
+                               ":\n        return x\n    return 0\n";
+        }
+        addEntry(corpus, request, 2.0);
+        return corpus;
+    }
+
+    std::string contents = AIEngine::readFileContents(path);
+    std::istringstream lines(contents);
+    std::string line;
+    size_t line_number = 0;
+    while (std::getline(lines, line)) {
+        line_number++;
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+        AIEngine::CodeRequest request;
+        bool stream = false;
+        std::string error;
+        if (!AIEngine::requestFromJson(line, AIEngine::RequestType::GENERATE_CODE, request, stream, error)) {
+            throw std::runtime_error(path + ":" + std::to_string(line_number) + ": " + error);
+        }
+
+        double weight = 1.0;
+        AIEngine::Json::Object fields;
+        AIEngine::Json::Parser(line).parseObject(fields);
+        const AIEngine::Json::Value* value = fields.find("weight");
+        if (value != nullptr && value->kind == AIEngine::Json::Value::Kind::NUMBER) {
+            weight = value->number;
+        }
+        addEntry(corpus, std::move(request), weight);
+    }
+    return corpus;
+}
+
+// One client connection; send() returns whether the engine reported success
+class Client {
+public:
+    virtual ~Client() = default;
+    virtual bool send(const CorpusEntry& entry) = 0;
+};
+
+class InProcessClient : public Client {
+private:
+    AIEngine::AIEngineServer& server;
+
+public:
+    explicit InProcessClient(AIEngine::AIEngineServer& engine) : server(engine) {}
+
+    bool send(const CorpusEntry& entry) override {
+        return server.processRequest(entry.request).error.empty();
+    }
+};
+
+class ShmLoadClient : public Client {
+private:
+    AIEngine::ShmClient& client;
+
+public:
+    explicit ShmLoadClient(AIEngine::ShmClient& shared) : client(shared) {}
+
+    bool send(const CorpusEntry& entry) override {
+        return client.processRequest(entry.request).error.empty();
+    }
+};
+
+// Blocking socket with exact reads and writes
+class Connection {
+private:
+    int fd;
+
+public:
+    explicit Connection(int socket_fd) : fd(socket_fd) {}
+    ~Connection() { if (fd >= 0) ::close(fd); }
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    void writeAll(const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t written = ::send(fd, data, size, MSG_NOSIGNAL);
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) throw std::runtime_error(std::string("send failed: ") + std::strerror(errno));
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+    // Appends up to max bytes to buffer; throws on EOF
+    void readSome(std::string& buffer, size_t max = 64 * 1024) {
+        size_t old_size = buffer.size();
+        buffer.resize(old_size + max);
+        while (true) {
+            ssize_t received = ::recv(fd, &buffer[old_size], max, 0);
+            if (received < 0 && errno == EINTR) continue;
+            if (received <= 0) {
+                buffer.resize(old_size);
+                throw std::runtime_error("connection closed by the engine");
+            }
+            buffer.resize(old_size + static_cast<size_t>(received));
+            return;
+        }
+    }
+};
+
+int connectUnix(const std::string& path) {
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) throw std::runtime_error("Socket path too long: " + path);
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        std::string message = "Cannot connect to " + path + ": " + std::strerror(errno);
+        if (fd >= 0) ::close(fd);
+        throw std::runtime_error(message);
+    }
+    return fd;
+}
+
+int connectTcp(const std::string& host, const std::string& port) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    int rc = ::getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses);
+    if (rc != 0) throw std::runtime_error("Cannot resolve " + host + ": " + gai_strerror(rc));
+
+    for (addrinfo* address = addresses; address; address = address->ai_next) {
+        int fd = ::socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+        if (fd < 0) continue;
+        if (::connect(fd, address->ai_addr, address->ai_addrlen) == 0) {
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            ::freeaddrinfo(addresses);
+            return fd;
+        }
+        ::close(fd);
+    }
+    ::freeaddrinfo(addresses);
+    throw std::runtime_error("Cannot connect to " + host + ":" + port);
+}
+
+class DaemonClient : public Client {
+private:
+    Connection connection;
+    std::string input;
+
+public:
+    explicit DaemonClient(const std::string& path) : connection(connectUnix(path)) {}
+
+    bool send(const CorpusEntry& entry) override {
+        connection.writeAll(entry.wire_frame.data(), entry.wire_frame.size());
+
+        uint32_t length;
+        while (!AIEngine::Wire::peekFrameLength(input, 0, length) ||
+               input.size() < AIEngine::Wire::kLengthPrefixSize + length) {
+            connection.readSome(input);
+        }
+
+        uint32_t request_id;
+        AIEngine::CodeResponse response;
+        bool decoded = AIEngine::Wire::decodeResponse(input.data() + AIEngine::Wire::kLengthPrefixSize, length,
+                                                      request_id, response);
+        input.erase(0, AIEngine::Wire::kLengthPrefixSize + length);
+        return decoded && response.error.empty();
+    }
+};
+
+class HttpClient : public Client {
+private:
+    Connection connection;
+    std::string head_generate;
+    std::string head_analyze;
+    std::string input;
+
+public:
+    HttpClient(const std::string& host, const std::string& port)
+        : connection(connectTcp(host, port)) {
+        std::string common = " HTTP/1.1\r\nHost: " + host + "\r\nContent-Type: application/json\r\nContent-Length: ";
+        head_generate = "POST /api/generate" + common;
+        head_analyze = "POST /api/analyze" + common;
+    }
+
+    bool send(const CorpusEntry& entry) override {
+        std::string message = entry.request.type == AIEngine::RequestType::ANALYZE_CODE ? head_analyze
+                                                                                       : head_generate;
+        message += std::to_string(entry.http_body.size());
+        message += "\r\n\r\n";
+        message += entry.http_body;
+        connection.writeAll(message.data(), message.size());
+
+        size_t head_end;
+        while ((head_end = input.find("\r\n\r\n")) == std::string::npos) {
+            connection.readSome(input);
+        }
+
+        size_t content_length = 0;
+        std::string head = input.substr(0, head_end);
+        std::transform(head.begin(), head.end(), head.begin(), ::tolower);
+        size_t field = head.find("\r\ncontent-length:");
+        if (field != std::string::npos) {
+            content_length = static_cast<size_t>(std::strtoull(head.c_str() + field + 17, nullptr, 10));
+        }
+        bool ok = head.compare(0, 12, "http/1.1 200") == 0;
+
+        size_t total = head_end + 4 + content_length;
+        while (input.size() < total) {
+            connection.readSome(input);
+        }
+        ok = ok && input.compare(head_end + 4, 15, "{\"success\":true") == 0;
+        input.erase(0, total);
+        return ok;
+    }
+};
+
+// Latency samples of one client thread, bucketed like the engine's metrics
+struct Recorder {
+    std::vector<uint64_t> latency = std::vector<uint64_t>(AIEngine::Metrics::Buckets::kCount, 0);
+    std::vector<uint64_t> service = std::vector<uint64_t>(AIEngine::Metrics::Buckets::kCount, 0);
+    uint64_t latency_max = 0;
+    uint64_t service_max = 0;
+    uint64_t completed = 0;
+    uint64_t errors = 0;
+
+    void record(uint64_t latency_ns, uint64_t service_ns, bool ok) {
+        latency[AIEngine::Metrics::Buckets::index(latency_ns)]++;
+        service[AIEngine::Metrics::Buckets::index(service_ns)]++;
+        latency_max = std::max(latency_max, latency_ns);
+        service_max = std::max(service_max, service_ns);
+        completed++;
+        if (!ok) errors++;
+    }
+};
+
+AIEngine::Metrics::HistogramSnapshot merge(const std::vector<Recorder>& recorders, bool use_latency) {
+    AIEngine::Metrics::HistogramSnapshot merged;
+    for (const Recorder& recorder : recorders) {
+        const std::vector<uint64_t>& counts = use_latency ? recorder.latency : recorder.service;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            merged.counts[i] += counts[i];
+            merged.count += counts[i];
+        }
+        merged.max = std::max(merged.max, use_latency ? recorder.latency_max : recorder.service_max);
+    }
+    return merged;
+}
+
+void printPercentiles(const char* label, const AIEngine::Metrics::HistogramSnapshot& histogram) {
+    char line[256];
+    auto ms = [](uint64_t nanoseconds) { return static_cast<double>(nanoseconds) / 1e6; };
+    std::snprintf(line, sizeof(line), "  %-22s p50 %8.3f  p90 %8.3f  p99 %8.3f  p999 %8.3f  max %8.3f ms\n",
+                  label, ms(histogram.percentile(0.50)), ms(histogram.percentile(0.90)),
+                  ms(histogram.percentile(0.99)), ms(histogram.percentile(0.999)), ms(histogram.max));
+    std::cout << line;
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n\n";
+    std::cout << "  --target T         inproc, unix:PATH, http://HOST:PORT or shm:/NAME (default inproc)\n";
+    std::cout << "  --connections N    Concurrent clients (default 16)\n";
+    std::cout << "  --rate R           Open loop at R requests/s (default: closed loop)\n";
+    std::cout << "  --poisson          Exponential inter-arrival times for --rate\n";
+    std::cout << "  --duration S       Measured seconds (default 10)\n";
+    std::cout << "  --warmup S         Unmeasured seconds before that (default 1)\n";
+    std::cout << "  --corpus FILE      JSONL requests with optional \"type\" and \"weight\"\n";
+    std::cout << "  --slo-p99 MS       Exit with status 1 if p99 latency exceeds MS\n";
+    std::cout << "  --seed N           Random seed for the request mix (default 42)\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (arg == "--target" && has_value) options.target = argv[++i];
+        else if (arg == "--connections" && has_value) options.connections = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        else if (arg == "--rate" && has_value) options.rate = std::max(0.0, std::atof(argv[++i]));
+        else if (arg == "--poisson") options.poisson = true;
+        else if (arg == "--duration" && has_value) options.duration_seconds = std::max(0.1, std::atof(argv[++i]));
+        else if (arg == "--warmup" && has_value) options.warmup_seconds = std::max(0.0, std::atof(argv[++i]));
+        else if (arg == "--corpus" && has_value) options.corpus_file = argv[++i];
+        else if (arg == "--slo-p99" && has_value) options.slo_p99_ms = std::atof(argv[++i]);
+        else if (arg == "--seed" && has_value) options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    try {
+        Corpus corpus = loadCorpus(options.corpus_file);
+        if (corpus.empty()) throw std::runtime_error("The corpus has no requests with positive weight");
+
+        std::unique_ptr<AIEngine::AIEngineServer> engine;
+        std::unique_ptr<AIEngine::ShmClient> shm;
+        std::function<std::unique_ptr<Client>()> connect;
+        const std::string& target = options.target;
+
+        if (target == "inproc") {
+            engine = std::make_unique<AIEngine::AIEngineServer>();
+            connect = [&engine]() { return std::unique_ptr<Client>(new InProcessClient(*engine)); };
+        } else if (target.compare(0, 5, "unix:") == 0) {
+            std::string path = target.substr(5);
+            connect = [path]() { return std::unique_ptr<Client>(new DaemonClient(path)); };
+        } else if (target.compare(0, 7, "http://") == 0) {
+            std::string address = target.substr(7, target.find('/', 7) - 7);
+            size_t colon = address.rfind(':');
+            std::string host = colon == std::string::npos ? address : address.substr(0, colon);
+            std::string port = colon == std::string::npos ? "80" : address.substr(colon + 1);
+            connect = [host, port]() { return std::unique_ptr<Client>(new HttpClient(host, port)); };
+        } else if (target.compare(0, 4, "shm:") == 0) {
+            shm = std::make_unique<AIEngine::ShmClient>(target.substr(4));
+            connect = [&shm]() { return std::unique_ptr<Client>(new ShmLoadClient(*shm)); };
+        } else {
+            throw std::runtime_error("Unknown target: " + target);
+        }
+
+        std::vector<std::unique_ptr<Client>> clients;
+        for (size_t i = 0; i < options.connections; ++i) {
+            clients.push_back(connect());
+        }
+
+        // Open loop: every request has a scheduled send time, claimed in
+        // order by whichever client is free
+        bool open_loop = options.rate > 0.0;
+        std::vector<double> schedule;
+        if (open_loop) {
+            std::mt19937_64 random(options.seed);
+            std::exponential_distribution<double> gap(options.rate);
+            double horizon = options.warmup_seconds + options.duration_seconds;
+            for (double at = 0.0; at < horizon;
+                 at += options.poisson ? gap(random) : 1.0 / options.rate) {
+                schedule.push_back(at);
+            }
+        }
+
+        auto start = Clock::now() + std::chrono::milliseconds(10);
+        auto measure_from = start + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(options.warmup_seconds));
+        auto stop = measure_from + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(options.duration_seconds));
+
+        std::atomic<size_t> next_scheduled{0};
+        std::atomic<bool> failed{false};
+        std::string failure;
+        std::mutex failure_mutex;
+        std::vector<Recorder> recorders(clients.size());
+        std::vector<std::thread> threads;
+
+        for (size_t c = 0; c < clients.size(); ++c) {
+            threads.emplace_back([&, c]() {
+                std::mt19937_64 random(options.seed + 1 + c);
+                Recorder& recorder = recorders[c];
+                std::this_thread::sleep_until(start);
+
+                try {
+                    while (!failed.load()) {
+                        Clock::time_point intended;
+                        if (open_loop) {
+                            size_t index = next_scheduled.fetch_add(1);
+                            if (index >= schedule.size()) break;
+                            intended = start + std::chrono::duration_cast<Clock::duration>(
+                                std::chrono::duration<double>(schedule[index]));
+                            std::this_thread::sleep_until(intended);
+                        } else {
+                            intended = Clock::now();
+                            if (intended >= stop) break;
+                        }
+
+                        const CorpusEntry& entry = corpus.pick(random);
+                        auto sent = Clock::now();
+                        bool ok = clients[c]->send(entry);
+                        auto done = Clock::now();
+
+                        if (intended >= measure_from && intended < stop) {
+                            recorder.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(done - intended).count()),
+                                            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(done - sent).count()),
+                                            ok);
+                        }
+                    }
+                } catch (const std::exception& e) {
+                    std::lock_guard<std::mutex> lock(failure_mutex);
+                    if (!failed.exchange(true)) failure = e.what();
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        auto finished = Clock::now();
+        if (failed.load()) throw std::runtime_error(failure);
+
+        uint64_t completed = 0;
+        uint64_t errors = 0;
+        for (const Recorder& recorder : recorders) {
+            completed += recorder.completed;
+            errors += recorder.errors;
+        }
+        double measured = std::chrono::duration<double>(std::min(finished, stop) - measure_from).count();
+        if (open_loop) {
+            // Requests scheduled in the window may finish after it
+            measured = std::chrono::duration<double>(std::max(finished, stop) - measure_from).count();
+        }
+
+        auto latency = merge(recorders, true);
+        auto service = merge(recorders, false);
+
+        std::cout << "target " << target << ", " << corpus.size() << " corpus requests, "
+                  << options.connections << " connections, ";
+        if (open_loop) {
+            std::cout << "open loop at " << options.rate << " req/s" << (options.poisson ? " (Poisson)" : "");
+        } else {
+            std::cout << "closed loop";
+        }
+        std::cout << "\n";
+
+        char line[256];
+        std::snprintf(line, sizeof(line), "  %llu requests in %.2fs: %.0f req/s, %llu errors\n",
+                      static_cast<unsigned long long>(completed), measured,
+                      measured > 0 ? static_cast<double>(completed) / measured : 0.0,
+                      static_cast<unsigned long long>(errors));
+        std::cout << line;
+        if (open_loop) {
+            printPercentiles("latency (corrected)", latency);
+            printPercentiles("service time", service);
+        } else {
+            printPercentiles("latency", service);
+        }
+
+        if (options.slo_p99_ms > 0) {
+            double p99 = static_cast<double>((open_loop ? latency : service).percentile(0.99)) / 1e6;
+            bool met = p99 <= options.slo_p99_ms && errors == 0;
+            std::snprintf(line, sizeof(line), "  SLO p99 <= %.3f ms: %s (p99 %.3f ms, %llu errors)\n",
+                          options.slo_p99_ms, met ? "PASS" : "FAIL", p99,
+                          static_cast<unsigned long long>(errors));
+            std::cout << line;
+            return met ? 0 : 1;
+        }
+        return errors == 0 ? 0 : 1;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Load generator error: " << e.what() << "\n";
+        return 1;
+    }
+}
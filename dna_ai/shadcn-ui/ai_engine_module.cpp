@@ -0,0 +1,318 @@
+/*
+AI Engine - Python Extension Module
+Exposes the C++ AIEngineServer to Python in-process, so api_server.py can
+call the engine directly instead of going through a subprocess or socket.
+
+Build with `make python-module`, then:
+
+    import ai_engine_native
+    server = ai_engine_native.AIEngineServer()
+    result = server.process_request("sort a list", language="python")
+
+The GIL is released while the engine runs, so requests issued from several
+Python threads (e.g. an asyncio executor) are processed in parallel.
+
+ShmClient talks to a separate engine process started with `--shm NAME`
+over a shared memory ring buffer instead of running the engine in-process.
+*/
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "ai_engine/ai_engine.h"
+
+namespace {
+
+struct PyAIEngineServer {
+    PyObject_HEAD
+    AIEngine::AIEngineServer* server;
+};
+
+struct PyShmClient {
+    PyObject_HEAD
+    AIEngine::ShmClient* client;
+};
+
+// Borrowed view of a str (via its cached UTF-8 form) or of any bytes-like
+// object (via the buffer protocol); no intermediate Python object is made
+class TextView {
+private:
+    Py_buffer buffer;
+    bool has_buffer = false;
+    std::string_view text;
+
+public:
+    TextView() = default;
+    TextView(const TextView&) = delete;
+    TextView& operator=(const TextView&) = delete;
+
+    ~TextView() {
+        if (has_buffer) PyBuffer_Release(&buffer);
+    }
+
+    bool acquire(PyObject* object, const char* name) {
+        if (object == nullptr || object == Py_None) {
+            return true;
+        }
+
+        if (PyUnicode_Check(object)) {
+            Py_ssize_t length;
+            const char* data = PyUnicode_AsUTF8AndSize(object, &length);
+            if (data == nullptr) return false;
+            text = std::string_view(data, static_cast<size_t>(length));
+            return true;
+        }
+
+        if (PyObject_CheckBuffer(object)) {
+            if (PyObject_GetBuffer(object, &buffer, PyBUF_SIMPLE) < 0) return false;
+            has_buffer = true;
+            text = std::string_view(static_cast<const char*>(buffer.buf), static_cast<size_t>(buffer.len));
+            return true;
+        }
+
+        PyErr_Format(PyExc_TypeError, "%s must be str or a bytes-like object, not %.100s",
+                     name, Py_TYPE(object)->tp_name);
+        return false;
+    }
+
+    std::string_view view() const { return text; }
+};
+
+bool parseRequestType(const char* type, AIEngine::RequestType& out) {
+    std::string value = type;
+    if (value == "generate") out = AIEngine::RequestType::GENERATE_CODE;
+    else if (value == "analyze") out = AIEngine::RequestType::ANALYZE_CODE;
+    else if (value == "execute") out = AIEngine::RequestType::EXECUTE_CODE;
+    else if (value == "optimize") out = AIEngine::RequestType::OPTIMIZE_CODE;
+    else {
+        PyErr_Format(PyExc_ValueError, "Unknown request type: %s", type);
+        return false;
+    }
+    return true;
+}
+
+PyObject* responseToDict(const AIEngine::CodeResponse& response) {
+    return Py_BuildValue(
+        "{s:O,s:s#,s:s#,s:f,s:s#,s:s#,s:d}",
+        "success", response.error.empty() ? Py_True : Py_False,
+        "code", response.code.data(), static_cast<Py_ssize_t>(response.code.size()),
+        "explanation", response.explanation.data(), static_cast<Py_ssize_t>(response.explanation.size()),
+        "confidence", static_cast<double>(response.confidence),
+        "execution_result", response.execution_result.data(),
+        static_cast<Py_ssize_t>(response.execution_result.size()),
+        "error", response.error.data(), static_cast<Py_ssize_t>(response.error.size()),
+        "processing_time", response.processing_time.count() / 1000.0);
+}
+
+struct RequestArgs {
+    TextView prompt;
+    TextView context;
+    AIEngine::Language language = AIEngine::Language::PYTHON;
+    int max_tokens = 1000;
+    float temperature = 0.7f;
+    AIEngine::RequestType type = AIEngine::RequestType::GENERATE_CODE;
+};
+
+bool parseRequestArgs(PyObject* args, PyObject* kwargs, RequestArgs& out) {
+    static const char* keywords[] = {
+        "prompt", "language", "context", "max_tokens", "temperature", "type", nullptr
+    };
+
+    PyObject* prompt = nullptr;
+    const char* language = "python";
+    PyObject* context = nullptr;
+    const char* type = "generate";
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|sOifs", const_cast<char**>(keywords),
+                                     &prompt, &language, &context, &out.max_tokens,
+                                     &out.temperature, &type)) {
+        return false;
+    }
+
+    out.language = AIEngine::stringToLanguage(language);
+    return out.prompt.acquire(prompt, "prompt") &&
+           out.context.acquire(context, "context") &&
+           parseRequestType(type, out.type);
+}
+
+// Runs call with the GIL released, turning C++ exceptions into RuntimeError
+template<typename Call>
+PyObject* runWithoutGil(Call&& call) {
+    AIEngine::CodeResponse response;
+    bool failed = false;
+    std::string failure;
+
+    Py_BEGIN_ALLOW_THREADS
+    try {
+        response = call();
+    } catch (const std::exception& e) {
+        failed = true;
+        failure = e.what();
+    }
+    Py_END_ALLOW_THREADS
+
+    if (failed) {
+        PyErr_SetString(PyExc_RuntimeError, failure.c_str());
+        return nullptr;
+    }
+    return responseToDict(response);
+}
+
+PyObject* serverNew(PyTypeObject* type, PyObject*, PyObject*) {
+    PyAIEngineServer* self = reinterpret_cast<PyAIEngineServer*>(type->tp_alloc(type, 0));
+    if (self == nullptr) return nullptr;
+
+    try {
+        self->server = new AIEngine::AIEngineServer();
+    } catch (const std::exception& e) {
+        Py_DECREF(self);
+        PyErr_SetString(PyExc_RuntimeError, e.what());
+        return nullptr;
+    }
+    return reinterpret_cast<PyObject*>(self);
+}
+
+void serverDealloc(PyAIEngineServer* self) {
+    PyTypeObject* type = Py_TYPE(self);
+    delete self->server;
+    type->tp_free(reinterpret_cast<PyObject*>(self));
+    Py_DECREF(type);  // heap types are referenced by their instances
+}
+
+PyObject* serverProcessRequest(PyAIEngineServer* self, PyObject* args, PyObject* kwargs) {
+    RequestArgs parsed;
+    if (!parseRequestArgs(args, kwargs, parsed)) return nullptr;
+
+    // The engine takes owned strings: one copy out of the Python objects
+    AIEngine::CodeRequest request;
+    request.prompt.assign(parsed.prompt.view());
+    request.context.assign(parsed.context.view());
+    request.language = parsed.language;
+    request.max_tokens = parsed.max_tokens;
+    request.temperature = parsed.temperature;
+    request.type = parsed.type;
+
+    return runWithoutGil([self, &request]() {
+        return self->server->processRequest(request);
+    });
+}
+
+PyObject* shmClientNew(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"name", nullptr};
+    const char* name = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", const_cast<char**>(keywords), &name)) {
+        return nullptr;
+    }
+
+    PyShmClient* self = reinterpret_cast<PyShmClient*>(type->tp_alloc(type, 0));
+    if (self == nullptr) return nullptr;
+
+    try {
+        self->client = new AIEngine::ShmClient(name);
+    } catch (const std::exception& e) {
+        Py_DECREF(self);
+        PyErr_SetString(PyExc_ConnectionError, e.what());
+        return nullptr;
+    }
+    return reinterpret_cast<PyObject*>(self);
+}
+
+void shmClientDealloc(PyShmClient* self) {
+    PyTypeObject* type = Py_TYPE(self);
+    delete self->client;
+    type->tp_free(reinterpret_cast<PyObject*>(self));
+    Py_DECREF(type);
+}
+
+PyObject* shmClientProcessRequest(PyShmClient* self, PyObject* args, PyObject* kwargs) {
+    RequestArgs parsed;
+    if (!parseRequestArgs(args, kwargs, parsed)) return nullptr;
+
+    // The views stay valid while the GIL is released because args keeps
+    // the objects alive; they are copied once, into shared memory
+    return runWithoutGil([self, &parsed]() {
+        return self->client->process(parsed.type, parsed.language, parsed.max_tokens,
+                                     parsed.temperature, parsed.prompt.view(), parsed.context.view());
+    });
+}
+
+PyMethodDef serverMethods[] = {
+    {"process_request", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(serverProcessRequest)),
+     METH_VARARGS | METH_KEYWORDS,
+     "process_request(prompt, language='python', context=None, max_tokens=1000, "
+     "temperature=0.7, type='generate') -> dict\n\n"
+     "Run one request through the C++ engine with the GIL released.\n"
+     "prompt and context may be str or any bytes-like object."},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+PyMethodDef shmClientMethods[] = {
+    {"process_request", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(shmClientProcessRequest)),
+     METH_VARARGS | METH_KEYWORDS,
+     "process_request(prompt, language='python', context=None, max_tokens=1000, "
+     "temperature=0.7, type='generate') -> dict\n\n"
+     "Send one request over the shared memory channel and wait for the\n"
+     "response with the GIL released. Safe to call from several threads."},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+PyType_Slot serverSlots[] = {
+    {Py_tp_new, reinterpret_cast<void*>(serverNew)},
+    {Py_tp_dealloc, reinterpret_cast<void*>(serverDealloc)},
+    {Py_tp_methods, serverMethods},
+    {Py_tp_doc, const_cast<char*>("C++ AIEngineServer; safe to share across threads")},
+    {0, nullptr}
+};
+
+PyType_Spec serverSpec = {
+    "ai_engine_native.AIEngineServer",
+    sizeof(PyAIEngineServer),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    serverSlots
+};
+
+PyType_Slot shmClientSlots[] = {
+    {Py_tp_new, reinterpret_cast<void*>(shmClientNew)},
+    {Py_tp_dealloc, reinterpret_cast<void*>(shmClientDealloc)},
+    {Py_tp_methods, shmClientMethods},
+    {Py_tp_doc, const_cast<char*>("ShmClient(name): client for an engine started with --shm name")},
+    {0, nullptr}
+};
+
+PyType_Spec shmClientSpec = {
+    "ai_engine_native.ShmClient",
+    sizeof(PyShmClient),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    shmClientSlots
+};
+
+PyModuleDef moduleDef = {
+    PyModuleDef_HEAD_INIT,
+    "ai_engine_native",
+    "In-process bindings for the C++ AI engine",
+    -1,
+    nullptr, nullptr, nullptr, nullptr, nullptr
+};
+
+} // namespace
+
+PyMODINIT_FUNC PyInit_ai_engine_native(void) {
+    PyObject* module = PyModule_Create(&moduleDef);
+    if (module == nullptr) return nullptr;
+
+    const std::pair<const char*, PyType_Spec*> types[] = {
+        {"AIEngineServer", &serverSpec},
+        {"ShmClient", &shmClientSpec},
+    };
+    for (const auto& entry : types) {
+        PyObject* type = PyType_FromSpec(entry.second);
+        if (type == nullptr || PyModule_AddObject(module, entry.first, type) < 0) {
+            Py_XDECREF(type);
+            Py_DECREF(module);
+            return nullptr;
+        }
+    }
+    return module;
+}
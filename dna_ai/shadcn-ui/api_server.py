@@ -13,12 +13,20 @@ import uvicorn
 from fastapi import FastAPI, HTTPException, BackgroundTasks
 from fastapi.middleware.cors import CORSMiddleware
 from pydantic import BaseModel
-import subprocess
 import os
-import tempfile
+import sys
 
 # Import our AI engine
 from ai_engine import AIEngineServer, CodeRequest, Language
+from cpp_engine_client import CppEngineClient, DEFAULT_SOCKET_PATH
+
+# In-process C++ engine (`make python-module`); falls back to the daemon
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "build"))
+try:
+    import ai_engine_native
+    HAS_NATIVE_ENGINE = True
+except ImportError:
+    HAS_NATIVE_ENGINE = False
 
 # Configure logging
 logging.basicConfig(level=logging.INFO)
@@ -43,6 +51,22 @@ app.add_middleware(
 # Global AI engine instance
 ai_engine = AIEngineServer()
 
+# The C++ engine runs in-process when the extension module is built, or in a
+# separate process reached over shared memory when AI_ENGINE_SHM names the
+# channel (`ai_engine --shm NAME`); otherwise through a persistent connection
+# to the daemon (`ai_engine --daemon`)
+native_engine = None
+if HAS_NATIVE_ENGINE:
+    shm_channel = os.environ.get("AI_ENGINE_SHM")
+    if shm_channel:
+        native_engine = ai_engine_native.ShmClient(shm_channel)
+    else:
+        native_engine = ai_engine_native.AIEngineServer()
+cpp_engine = CppEngineClient(os.environ.get("AI_ENGINE_SOCKET", DEFAULT_SOCKET_PATH))
+
+# Seconds to wait for a C++ engine response
+CPP_ENGINE_TIMEOUT = 30
+
 # Pydantic models for API
 class GenerateCodeRequest(BaseModel):
     prompt: str
@@ -76,6 +100,7 @@ async def startup_event():
 async def shutdown_event():
     """Cleanup on shutdown"""
     logger.info("Shutting down AI Engine API Server...")
+    await cpp_engine.close()
 
 @app.get("/")
 async def root():
@@ -201,55 +226,58 @@ async def execute_code(request: ExecuteCodeRequest, background_tasks: Background
 async def cpp_generate_code(request: GenerateCodeRequest):
     """Generate code using C++ AI engine"""
     try:
-        # Create temporary input file
-        with tempfile.NamedTemporaryFile(mode='w', suffix='.json', delete=False) as f:
-            input_data = {
-                'prompt': request.prompt,
-                'language': request.language,
-                'context': request.context or '',
-                'max_tokens': request.max_tokens,
-                'temperature': request.temperature
-            }
-            json.dump(input_data, f)
-            input_file = f.name
+        if native_engine is not None:
+            # The module releases the GIL, so executor threads run in parallel
+            result = await asyncio.get_running_loop().run_in_executor(
+                None,
+                lambda: native_engine.process_request(
+                    request.prompt,
+                    language=request.language,
+                    context=request.context,
+                    max_tokens=request.max_tokens,
+                    temperature=request.temperature
+                )
+            )
+        else:
+            result = await asyncio.wait_for(
+                cpp_engine.request(
+                    prompt=request.prompt,
+                    language=request.language,
+                    context=request.context or '',
+                    max_tokens=request.max_tokens,
+                    temperature=request.temperature
+                ),
+                timeout=CPP_ENGINE_TIMEOUT
+            )
         
-        try:
-            # Run C++ AI engine
-            result = subprocess.run(
-                ['./build/ai_engine', input_file],
-                capture_output=True,
-                text=True,
-                timeout=30
+        if result['success']:
+            return APIResponse(
+                success=True,
+                data={
+                    'code': result['code'],
+                    'explanation': result['explanation'],
+                    'confidence': result['confidence']
+                },
+                processing_time=result['processing_time']
+            )
+        else:
+            return APIResponse(
+                success=False,
+                error=f"C++ engine failed: {result['error']}"
             )
             
-            if result.returncode == 0:
-                # Parse output
-                output_lines = result.stdout.strip().split('\n')
-                generated_code = '\n'.join(output_lines[2:])  # Skip header lines
-                
-                return APIResponse(
-                    success=True,
-                    data={
-                        'code': generated_code,
-                        'explanation': 'Generated using C++ AI engine',
-                        'confidence': 0.85
-                    }
-                )
-            else:
-                return APIResponse(
-                    success=False,
-                    error=f"C++ engine failed: {result.stderr}"
-                )
-                
-        finally:
-            # Cleanup temp file
-            os.unlink(input_file)
-            
-    except subprocess.TimeoutExpired:
+    except asyncio.TimeoutError:
         return APIResponse(
             success=False,
             error="C++ engine timeout"
         )
+    except (ConnectionError, FileNotFoundError) as e:
+        logger.error(f"C++ engine daemon unavailable: {e}")
+        return APIResponse(
+            success=False,
+            error=f"C++ engine daemon not reachable at {cpp_engine.socket_path} "
+                  f"(start it with ./build/ai_engine --daemon)"
+        )
     except Exception as e:
         logger.error(f"C++ engine execution failed: {e}")
         return APIResponse(
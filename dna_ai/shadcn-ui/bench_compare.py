@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""
+Regression gate for the microbenchmarks
+Compares two ai_engine_bench --json result files benchmark by benchmark.
+A benchmark regresses when its median got slower by more than --threshold
+percent AND a two-sided Mann-Whitney U test on the per-sample timings says
+the difference is significant at --alpha; noise alone does not fail the
+gate. Exits with status 1 if any benchmark regressed:
+
+    ./build/ai_engine_bench --json before.json
+    ... change the code, rebuild ...
+    ./build/ai_engine_bench --json after.json
+    python3 bench_compare.py before.json after.json --threshold 5
+"""
+
+import argparse
+import json
+import math
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        results = json.load(f)
+    return {bench["name"]: bench for bench in results["benchmarks"]}
+
+
+def median(values):
+    ordered = sorted(values)
+    middle = len(ordered) // 2
+    if len(ordered) % 2:
+        return ordered[middle]
+    return (ordered[middle - 1] + ordered[middle]) / 2
+
+
+def mann_whitney(a, b):
+    """Two-sided p-value of the Mann-Whitney U test (normal approximation
+    with tie and continuity correction; fine for the bench's 15 samples)"""
+    n1, n2 = len(a), len(b)
+    if n1 == 0 or n2 == 0:
+        return 1.0
+
+    # Average ranks over the pooled samples, tied values sharing a rank
+    pooled = sorted([(value, 0) for value in a] + [(value, 1) for value in b])
+    ranks = [0.0] * len(pooled)
+    tie_term = 0.0
+    i = 0
+    while i < len(pooled):
+        j = i
+        while j + 1 < len(pooled) and pooled[j + 1][0] == pooled[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = (i + j) / 2 + 1
+        tied = j - i + 1
+        tie_term += tied ** 3 - tied
+        i = j + 1
+
+    rank_sum = sum(rank for rank, (_, group) in zip(ranks, pooled) if group == 0)
+    u = rank_sum - n1 * (n1 + 1) / 2
+    mean = n1 * n2 / 2
+    n = n1 + n2
+    variance = n1 * n2 / 12 * ((n + 1) - tie_term / (n * (n - 1)))
+    if variance <= 0:
+        return 1.0
+    z = (abs(u - mean) - 0.5) / math.sqrt(variance)
+    return min(1.0, math.erfc(max(z, 0.0) / math.sqrt(2)))
+
+
+def format_ns(nanoseconds):
+    if nanoseconds < 1e3:
+        return f"{nanoseconds:.1f} ns"
+    if nanoseconds < 1e6:
+        return f"{nanoseconds / 1e3:.2f} us"
+    return f"{nanoseconds / 1e6:.2f} ms"
+
+
+def compare(baseline, candidate, threshold, alpha, name_filter):
+    regressions = []
+    print(f"{'benchmark':<34} {'baseline':>12} {'candidate':>12} {'change':>8} {'p-value':>8}")
+    for name in sorted(set(baseline) | set(candidate)):
+        if name_filter and name_filter not in name:
+            continue
+        if name not in baseline or name not in candidate:
+            print(f"{name:<34} {'only in ' + ('baseline' if name in baseline else 'candidate'):>26}")
+            continue
+
+        before = baseline[name]["samples_ns"]
+        after = candidate[name]["samples_ns"]
+        before_median, after_median = median(before), median(after)
+        change = 100.0 * (after_median - before_median) / before_median if before_median > 0 else 0.0
+        p_value = mann_whitney(before, after)
+
+        verdict = ""
+        if p_value < alpha and change > threshold:
+            verdict = "REGRESSION"
+            regressions.append(name)
+        elif p_value < alpha and change < -threshold:
+            verdict = "faster"
+        print(f"{name:<34} {format_ns(before_median):>12} {format_ns(after_median):>12} "
+              f"{change:>+7.1f}% {p_value:>8.4f}  {verdict}")
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two ai_engine_bench JSON results")
+    parser.add_argument("baseline", help="Results before the change (ai_engine_bench --json)")
+    parser.add_argument("candidate", help="Results after the change")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="Median slowdown in percent tolerated (default 5)")
+    parser.add_argument("--alpha", type=float, default=0.01,
+                        help="Significance level of the Mann-Whitney test (default 0.01)")
+    parser.add_argument("--filter", default="", help="Only compare benchmarks containing this")
+    args = parser.parse_args()
+
+    regressions = compare(load(args.baseline), load(args.candidate), args.threshold, args.alpha, args.filter)
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) regressed by more than {args.threshold:g}%: "
+              + ", ".join(regressions))
+        sys.exit(1)
+    print(f"\nNo significant regressions beyond {args.threshold:g}%")
+
+
+if __name__ == "__main__":
+    main()
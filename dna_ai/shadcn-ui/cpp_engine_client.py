@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""
+Client for the C++ AI engine daemon
+Speaks the length-prefixed binary protocol served by `ai_engine --daemon`
+over a Unix domain socket, with any number of requests pipelined per connection
+"""
+
+import asyncio
+import struct
+from typing import Dict, Any, Optional
+
+DEFAULT_SOCKET_PATH = "/tmp/ai_engine.sock"
+
+# Numeric values match the C++ Language and RequestType enums
+LANGUAGE_CODES = {
+    "python": 0, "py": 0,
+    "cpp": 1, "c++": 1, "cxx": 1,
+    "javascript": 2, "js": 2,
+    "html": 3,
+    "css": 4,
+}
+UNKNOWN_LANGUAGE = 5
+
+REQUEST_TYPES = {
+    "generate": 0,
+    "analyze": 1,
+    "execute": 2,
+    "optimize": 3,
+}
+
+_REQUEST_HEADER = struct.Struct("<IIBBHif")
+_RESPONSE_HEADER = struct.Struct("<IBxxxfI")
+_LENGTH = struct.Struct("<I")
+
+
+def encode_request(request_id: int, prompt: str, language: str = "python",
+                   context: str = "", max_tokens: int = 1000,
+                   temperature: float = 0.7, request_type: str = "generate") -> bytes:
+    """Encode one request frame, including its length prefix"""
+    prompt_bytes = prompt.encode("utf-8")
+    context_bytes = (context or "").encode("utf-8")
+    payload_length = (_REQUEST_HEADER.size - _LENGTH.size + 8 +
+                      len(prompt_bytes) + len(context_bytes))
+
+    return b"".join([
+        _REQUEST_HEADER.pack(payload_length, request_id,
+                             REQUEST_TYPES[request_type],
+                             LANGUAGE_CODES.get(language.lower(), UNKNOWN_LANGUAGE),
+                             0, max_tokens, temperature),
+        _LENGTH.pack(len(prompt_bytes)), prompt_bytes,
+        _LENGTH.pack(len(context_bytes)), context_bytes,
+    ])
+
+
+def decode_response(payload: bytes) -> Dict[str, Any]:
+    """Decode a response payload (without its length prefix)"""
+    request_id, status, confidence, processing_time = _RESPONSE_HEADER.unpack_from(payload, 0)
+    offset = _RESPONSE_HEADER.size
+    fields = []
+    for _ in range(4):
+        (length,) = _LENGTH.unpack_from(payload, offset)
+        offset += _LENGTH.size
+        fields.append(payload[offset:offset + length].decode("utf-8", errors="replace"))
+        offset += length
+
+    code, explanation, execution_result, error = fields
+    return {
+        "request_id": request_id,
+        "success": status == 0,
+        "code": code,
+        "explanation": explanation,
+        "execution_result": execution_result,
+        "error": error,
+        "confidence": confidence,
+        "processing_time": processing_time / 1000.0,
+    }
+
+
+class CppEngineClient:
+    """Pipelined asyncio client for the C++ engine daemon"""
+
+    def __init__(self, socket_path: str = DEFAULT_SOCKET_PATH):
+        self.socket_path = socket_path
+        self._reader: Optional[asyncio.StreamReader] = None
+        self._writer: Optional[asyncio.StreamWriter] = None
+        self._reader_task: Optional[asyncio.Task] = None
+        self._pending: Dict[int, asyncio.Future] = {}
+        self._next_id = 1
+        self._connect_lock = asyncio.Lock()
+
+    async def request(self, prompt: str, language: str = "python", context: str = "",
+                      max_tokens: int = 1000, temperature: float = 0.7,
+                      request_type: str = "generate") -> Dict[str, Any]:
+        """Send one request and wait for its response"""
+        await self._ensure_connected()
+
+        request_id = self._next_id
+        self._next_id = (self._next_id + 1) & 0xFFFFFFFF or 1
+        future = asyncio.get_running_loop().create_future()
+        self._pending[request_id] = future
+
+        self._writer.write(encode_request(request_id, prompt, language, context,
+                                          max_tokens, temperature, request_type))
+        await self._writer.drain()
+        return await future
+
+    async def close(self):
+        if self._writer is not None:
+            self._writer.close()
+            await self._writer.wait_closed()
+        if self._reader_task is not None:
+            await self._reader_task
+
+    async def _ensure_connected(self):
+        async with self._connect_lock:
+            if self._writer is not None and not self._writer.is_closing():
+                return
+            self._reader, self._writer = await asyncio.open_unix_connection(self.socket_path)
+            self._reader_task = asyncio.create_task(self._read_responses())
+
+    async def _read_responses(self):
+        error: Exception = ConnectionError("C++ engine daemon closed the connection")
+        try:
+            while True:
+                (length,) = _LENGTH.unpack(await self._reader.readexactly(_LENGTH.size))
+                response = decode_response(await self._reader.readexactly(length))
+                future = self._pending.pop(response["request_id"], None)
+                if future is not None and not future.done():
+                    future.set_result(response)
+        except (asyncio.IncompleteReadError, ConnectionError) as e:
+            if isinstance(e, ConnectionError):
+                error = e
+        finally:
+            self._writer = None
+            for future in self._pending.values():
+                if not future.done():
+                    future.set_exception(error)
+            self._pending.clear()
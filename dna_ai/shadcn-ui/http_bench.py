@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""
+HTTP load generator for the AI engine endpoints
+Drives /api/generate (or any POST endpoint) over keep-alive connections and
+reports throughput and latency percentiles, so the C++ engine's built-in
+HTTP server (`ai_engine --http 8080`) can be compared with api_server.py:
+
+    python3 http_bench.py --url http://127.0.0.1:8080/api/generate
+    python3 http_bench.py --url http://127.0.0.1:8000/api/generate
+"""
+
+import argparse
+import asyncio
+import json
+import time
+from urllib.parse import urlparse
+
+
+async def read_response(reader: asyncio.StreamReader) -> int:
+    """Read one HTTP/1.1 response (Content-Length or chunked) and return its status"""
+    status_line = await reader.readline()
+    if not status_line:
+        raise ConnectionError("server closed the connection")
+    status = int(status_line.split()[1])
+
+    content_length = 0
+    chunked = False
+    while True:
+        line = await reader.readline()
+        if line in (b"\r\n", b"\n", b""):
+            break
+        name, _, value = line.decode("latin-1").partition(":")
+        name = name.strip().lower()
+        if name == "content-length":
+            content_length = int(value.strip())
+        elif name == "transfer-encoding" and "chunked" in value.lower():
+            chunked = True
+
+    if chunked:
+        while True:
+            size = int((await reader.readline()).strip(), 16)
+            await reader.readexactly(size + 2)
+            if size == 0:
+                break
+    else:
+        await reader.readexactly(content_length)
+    return status
+
+
+async def worker(url, body: bytes, deadline: float, latencies: list, errors: list):
+    reader, writer = await asyncio.open_connection(url.hostname, url.port or 80)
+    request = (f"POST {url.path} HTTP/1.1\r\nHost: {url.hostname}\r\n"
+               f"Content-Type: application/json\r\nContent-Length: {len(body)}\r\n\r\n").encode() + body
+    try:
+        while time.perf_counter() < deadline:
+            start = time.perf_counter()
+            writer.write(request)
+            await writer.drain()
+            status = await read_response(reader)
+            latencies.append(time.perf_counter() - start)
+            if status != 200:
+                errors.append(status)
+    finally:
+        writer.close()
+
+
+def percentile(sorted_values, fraction):
+    if not sorted_values:
+        return 0.0
+    index = min(len(sorted_values) - 1, int(fraction * len(sorted_values)))
+    return sorted_values[index]
+
+
+async def run(args):
+    url = urlparse(args.url)
+    body = json.dumps({
+        "prompt": args.prompt,
+        "language": args.language,
+        "context": "x" * args.context_size,
+    }).encode()
+
+    latencies, errors = [], []
+    deadline = time.perf_counter() + args.duration
+    started = time.perf_counter()
+    await asyncio.gather(*[worker(url, body, deadline, latencies, errors)
+                           for _ in range(args.connections)])
+    elapsed = time.perf_counter() - started
+
+    latencies.sort()
+    print(f"{args.url}: {len(latencies)} requests in {elapsed:.2f}s "
+          f"({len(latencies) / elapsed:.0f} req/s), {len(errors)} errors, "
+          f"{args.connections} connections")
+    for label, fraction in (("p50", 0.50), ("p90", 0.90), ("p99", 0.99), ("max", 1.0)):
+        print(f"  {label}: {percentile(latencies, fraction) * 1000:.3f} ms")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="HTTP load generator for the AI engine")
+    parser.add_argument("--url", default="http://127.0.0.1:8080/api/generate")
+    parser.add_argument("--connections", type=int, default=16)
+    parser.add_argument("--duration", type=float, default=10.0, help="Seconds to run")
+    parser.add_argument("--prompt", default="create a function to calculate fibonacci numbers")
+    parser.add_argument("--language", default="cpp")
+    parser.add_argument("--context-size", type=int, default=0, help="Bytes of context per request")
+    asyncio.run(run(parser.parse_args()))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,32 @@
+/*
+AI Engine - Public interface
+Everything an embedder needs to run the engine in-process: link
+libaiengine (build/libaiengine.a or build/libaiengine.so) and include
+this header, or only the component headers that are used.
+*/
+
+#ifndef AI_ENGINE_AI_ENGINE_H
+#define AI_ENGINE_AI_ENGINE_H
+
+#include "ai_engine/types.h"
+#include "ai_engine/trace.h"
+#include "ai_engine/metrics.h"
+#include "ai_engine/kernels.h"
+#include "ai_engine/model.h"
+#include "ai_engine/grammar.h"
+#include "ai_engine/prompt.h"
+#include "ai_engine/templates.h"
+#include "ai_engine/router.h"
+#include "ai_engine/generator.h"
+#include "ai_engine/analyzer.h"
+#include "ai_engine/snapshot.h"
+#include "ai_engine/server.h"
+#include "ai_engine/worker_pool.h"
+#include "ai_engine/wire.h"
+#include "ai_engine/io_backend.h"
+#include "ai_engine/socket_server.h"
+#include "ai_engine/json.h"
+#include "ai_engine/http_server.h"
+#include "ai_engine/shm.h"
+
+#endif // AI_ENGINE_AI_ENGINE_H
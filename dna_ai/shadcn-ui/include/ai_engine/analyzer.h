@@ -0,0 +1,40 @@
+/*
+AI Engine - Code analyzer
+Size, complexity, structure and common issues of a piece of code
+*/
+
+#ifndef AI_ENGINE_ANALYZER_H
+#define AI_ENGINE_ANALYZER_H
+
+#include <string>
+#include <vector>
+
+#include "ai_engine/types.h"
+
+namespace AIEngine {
+
+class CodeAnalyzer {
+public:
+    struct AnalysisResult {
+        int lines_of_code;
+        int cyclomatic_complexity;
+        std::vector<std::string> functions;
+        std::vector<std::string> classes;
+        std::vector<std::string> issues;
+        float maintainability_index;
+    };
+
+    AnalysisResult analyzeCode(const std::string& code, Language language);
+
+private:
+    int countLines(const std::string& code);
+    int calculateComplexity(const std::string& code, Language language);
+    std::vector<std::string> extractFunctions(const std::string& code, Language language);
+    std::vector<std::string> extractClasses(const std::string& code, Language language);
+    std::vector<std::string> findIssues(const std::string& code, Language language);
+    float calculateMaintainability(const AnalysisResult& result);
+};
+
+} // namespace AIEngine
+
+#endif // AI_ENGINE_ANALYZER_H
@@ -0,0 +1,79 @@
+/*
+AI Engine - Code generator
+Generates code from a prompt with the neural network for complex requests
+and from per-language templates otherwise, as the router decides from the
+prompt and the current load. The network, tokenizer and
+templates are immutable and shared by all generators; each is built the
+first time any generator needs it. The template library can be replaced
+while requests are running: each request renders from the library that
+was current when it started.
+*/
+
+#ifndef AI_ENGINE_GENERATOR_H
+#define AI_ENGINE_GENERATOR_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ai_engine/grammar.h"
+#include "ai_engine/model.h"
+#include "ai_engine/prompt.h"
+#include "ai_engine/templates.h"
+#include "ai_engine/types.h"
+
+namespace AIEngine {
+
+class CodeGenerator {
+private:
+    std::shared_ptr<const NeuralNetwork> model;
+    std::shared_ptr<const TokenProcessor> tokenizer;
+    std::once_flag model_once;
+    std::once_flag tokenizer_once;
+
+public:
+    CodeGenerator() = default;
+
+    // Built-in templates, used until a library is loaded
+    static TemplateLibrary initializeTemplates();
+    static std::shared_ptr<const TemplateLibrary> sharedTemplates();
+    // Makes library the process-wide templates; false if they are in use
+    // already. alongside installs state that goes with them while the
+    // templates are held: if it fails, library is not installed either.
+    static bool installSharedTemplates(std::shared_ptr<const TemplateLibrary> library,
+                                       const std::function<bool()>& alongside);
+    // Replaces the process-wide templates without waiting for requests
+    // rendering from the current ones, which finish on those
+    static void swapTemplates(std::shared_ptr<const TemplateLibrary> library);
+    // Loads a template directory (see TemplateLibrary::loadDirectory) and
+    // swaps it in; on error the current templates stay in place
+    static size_t reloadTemplates(const std::string& directory);
+
+    CodeResponse generateCode(const CodeRequest& request);
+
+private:
+    // Acquire the shared components on first use, so template-only traffic
+    // never initialises the network
+    const NeuralNetwork& network();
+    const TokenProcessor& tokens();
+    // Decoding grammar of a language, shared by all generators
+    const TokenGrammar& grammar(Language language);
+
+    // shallow: the early-exit network the router picks under load
+    std::string generateWithNN(const CodeRequest& request, bool shallow);
+    std::string generateWithTemplate(const CodeRequest& request, const PromptFeatures& features);
+    std::string replacePlaceholders(const CompiledTemplate& compiled, const CodeRequest& request,
+                                    const PromptFeatures& features);
+    std::string extractFunctionName(const PromptFeatures& features);
+    std::string capitalizeFirst(const std::string& str);
+    std::string generateFunctionBody(const CodeRequest& request);
+    std::string inferReturnType(const CodeRequest& request, const PromptFeatures& features);
+    std::string formatGeneratedCode(const std::string& raw_code, Language lang);
+};
+
+} // namespace AIEngine
+
+#endif // AI_ENGINE_GENERATOR_H
@@ -0,0 +1,74 @@
+/*
+AI Engine - Token grammars
+A per-language automaton over the tokenizer's vocabulary that neural
+decoding is constrained by: brackets balance, operators sit between
+operands, statements start where the language allows them, if, while and
+for take their parenthesised condition or three-clause header before the
+body, #include takes one header and ends its line, declarations are
+specifiers, a name and then parameters, '=' or ';', definitions are a
+name, a parameter list and a body, and keywords of other languages never
+appear. States are a syntactic position and a bounded stack of brackets,
+which also record the construct they close; only those reachable from
+the start are numbered, and everything is precomputed: a validity bitset
+per state, the transition table, and the shortest completion from every
+state to an accepting one. A decoding step is a bitset scan and a table
+load.
+*/
+
+#ifndef AI_ENGINE_GRAMMAR_H
+#define AI_ENGINE_GRAMMAR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ai_engine/types.h"
+
+namespace AIEngine {
+
+class TokenGrammar {
+public:
+    // Deepest bracket nesting the automaton tracks; opening one more is masked
+    static constexpr size_t kMaxDepth = 4;
+
+private:
+    static constexpr uint16_t kInvalid = 0xFFFF;
+
+    size_t vocab_size;
+    size_t words;                    // 64-bit words per validity bitset
+    std::vector<uint64_t> masks;     // words per state: tokens that may follow it
+    std::vector<uint16_t> next;      // vocab_size per state: target, or kInvalid
+    std::vector<int32_t> completion; // per state: first token of the shortest completion, -1 if accepting
+    int end_token;                   // -1 when the vocabulary has none
+
+public:
+    TokenGrammar(Language language, const std::vector<std::string>& vocabulary);
+
+    static uint32_t start() { return 0; }
+    size_t stateCount() const { return completion.size(); }
+    bool accepting(uint32_t state) const { return completion[state] < 0; }
+
+    bool valid(uint32_t state, int token) const {
+        return token >= 0 && static_cast<size_t>(token) < vocab_size &&
+               ((masks[state * words + (static_cast<size_t>(token) >> 6)] >> (token & 63)) & 1u);
+    }
+    uint32_t advance(uint32_t state, int token) const {
+        return next[state * vocab_size + static_cast<size_t>(token)];
+    }
+
+    // The first token valid in state at or after proposal in id order,
+    // wrapping around; -1 if none is (never for a reachable state)
+    int constrain(uint32_t state, int proposal) const;
+
+    // Decodes a sequence of proposed token ids: each is replaced by the
+    // nearest valid token, ids outside the vocabulary are skipped, the end
+    // token stops decoding where the output may end, and the shortest
+    // completion closes whatever is still open, so the result is always
+    // a sentence of the grammar.
+    std::vector<int> decode(const std::vector<int>& proposals) const;
+};
+
+} // namespace AIEngine
+
+#endif // AI_ENGINE_GRAMMAR_H
@@ -0,0 +1,70 @@
+/*
+AI Engine - HTTP transport
+Epoll-based HTTP/1.1 server exposing the same /api/generate and
+/api/analyze endpoints as api_server.py, for callers that want to skip
+the Python hop. Connections are kept alive and pipelined requests are
+answered in order. Generation requests with "stream": true get a chunked
+NDJSON response: "code" events with pieces of the output, then "done".
+*/
+
+#ifndef AI_ENGINE_HTTP_SERVER_H
+#define AI_ENGINE_HTTP_SERVER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "ai_engine/socket_server.h"
+
+namespace AIEngine {
+
+class HttpServer : public SocketServer {
+public:
+    HttpServer(AIEngineServer& engine_ref, const std::string& host, int port, size_t worker_count,
+               IoBackendKind backend_kind = IoBackendKind::AUTO)
+        : SocketServer(engine_ref, openTcpSocket(host, port), worker_count, backend_kind, true) {}
+
+    static int openTcpSocket(const std::string& host, int port);
+
+protected:
+    void onAccept(int fd) override;
+    bool onInput(uint64_t connection_id, Connection& conn) override;
+
+private:
+    static constexpr size_t kMaxHeaderSize = 64 * 1024;
+    static constexpr size_t kMaxBodySize = 64 * 1024 * 1024;
+    static constexpr size_t kStreamChunkSize = 4096;
+    static constexpr uint32_t kStateClosing = 1;
+    static constexpr uint32_t kStateContinueSent = 2;
+
+    struct Request {
+        std::string_view method;
+        std::string_view path;
+        int minor_version = 1;
+        size_t content_length = 0;
+        bool keep_alive = true;
+        bool chunked = false;
+        bool expect_continue = false;
+    };
+
+    static bool equalsIgnoreCase(std::string_view a, std::string_view b);
+    static std::string_view trim(std::string_view value);
+    static bool parseHead(std::string_view head, Request& request);
+
+    void route(uint64_t connection_id, Connection& conn, const Request& request, std::string_view body);
+
+    static std::string responseHead(int status, const char* reason, const char* content_type,
+                                    size_t content_length, bool keep_alive, int minor_version);
+    static std::string jsonResponse(const std::string& json, bool keep_alive, int minor_version);
+    void replyError(uint64_t connection_id, Connection& conn, int status, const char* reason, bool keep_alive);
+    static void appendChunk(std::string& out, const std::string& data);
+
+    // Generated code as a series of {"type":"code"} events, split at line
+    // boundaries where possible, followed by a {"type":"done"} summary
+    static std::string streamedResponse(const CodeResponse& response, bool keep_alive);
+};
+
+} // namespace AIEngine
+
+#endif // AI_ENGINE_HTTP_SERVER_H
@@ -0,0 +1,68 @@
+/*
+AI Engine - Socket I/O backends
+Completion-style socket I/O underneath SocketServer. The epoll backend
+emulates completions with non-blocking calls on readiness; the io_uring
+backend queues operations and submits them in one batch per loop
+iteration, receiving into registered buffers where it can.
+*/
+
+#ifndef AI_ENGINE_IO_BACKEND_H
+#define AI_ENGINE_IO_BACKEND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace AIEngine {
+
+class IoBackend {
+public:
+    class Handler {
+    public:
+        virtual ~Handler() = default;
+        virtual void onAccepted(int fd) = 0;
+        // size 0 means the peer closed its side
+        virtual void onReceived(uint64_t key, const char* data, size_t size) = 0;
+        virtual void onSent(uint64_t key) = 0;
+        virtual void onFailed(uint64_t key) = 0;
+        virtual void onWake() = 0;
+    };
+
+    virtual ~IoBackend() = default;
+    virtual const char* name() const = 0;
+
+    // Start receiving on an accepted socket; the backend owns fd from now on
+    virtual void addConnection(uint64_t key, int fd) = 0;
+    virtual void stopReceiving(uint64_t key) = 0;
+    // Flow control: input stays in the socket until resumed (at most one
+    // receive already under way is still delivered)
+    virtual void pauseReceiving(uint64_t key) = 0;
+    virtual void resumeReceiving(uint64_t key) = 0;
+    // Write all of data; it must stay valid until onSent. One send at a time.
+    virtual void send(uint64_t key, const char* data, size_t size) = 0;
+    virtual void closeConnection(uint64_t key) = 0;
+
+    virtual void run(Handler& handler) = 0;
+    // Safe to call from any thread or from a signal handler
+    virtual void wake() = 0;
+    virtual void stop() = 0;
+};
+
+enum class IoBackendKind {
+    AUTO,
+    EPOLL,
+    URING
+};
+
+// io_uring for URING, epoll for EPOLL, and for AUTO io_uring if available,
+// else epoll; throws if URING is requested and io_uring is unavailable
+std::unique_ptr<IoBackend> makeIoBackend(IoBackendKind kind, int listen_fd);
+
+// Reads a whole file, through io_uring with several chunk reads in flight
+// per submission when available, or with pread otherwise
+std::string readFileContents(const std::string& path);
+
+} // namespace AIEngine
+
+#endif // AI_ENGINE_IO_BACKEND_H
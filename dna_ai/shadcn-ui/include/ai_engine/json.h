@@ -0,0 +1,123 @@
+/*
+AI Engine - JSON
+Minimal JSON support for the HTTP endpoints: flat request objects in,
+response objects out. Requests are decoded on demand: strings are kept
+as views into the input and only unescaped when they contain escapes,
+so a large "context" is scanned once and copied once.
+*/
+
+#ifndef AI_ENGINE_JSON_H
+#define AI_ENGINE_JSON_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "ai_engine/types.h"
+
+namespace AIEngine {
+namespace Json {
+
+struct Value {
+    enum class Kind { STRING, NUMBER, BOOLEAN, NUL, OTHER };
+    Kind kind = Kind::NUL;
+    std::string_view raw;   // string contents between the quotes, still escaped
+    bool escaped = false;
+    double number = 0.0;
+    bool boolean = false;
+
+    // Appends the unescaped string; raw has already been validated
+    void decodeTo(std::string& out) const;
+};
+
+// The members of a parsed object, in input order
+class Object {
+private:
+    std::vector<std::pair<std::string_view, Value>> members;
+    std::deque<std::string> decoded_keys;  // keys that contained escapes
+
+    friend class Parser;
+
+public:
+    // Later duplicates win, as with most JSON libraries
+    const Value* find(std::string_view key) const {
+        for (auto it = members.rbegin(); it != members.rend(); ++it) {
+            if (it->first == key) return &it->second;
+        }
+        return nullptr;
+    }
+};
+
+inline void appendString(std::string& out, std::string_view value) {
+    static const char* hex = "0123456789abcdef";
+    out.push_back('"');
+    for (char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00";
+                    out.push_back(hex[(c >> 4) & 0xf]);
+                    out.push_back(hex[c & 0xf]);
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+}
+class Parser {
+private:
+    std::string_view text;
+    size_t pos;
+
+public:
+    explicit Parser(std::string_view input) : text(input), pos(0) {}
+
+    // Parses a top-level object; nested objects and arrays are validated
+    // and reported as Kind::OTHER. Views in object point into the input.
+    bool parseObject(Object& object);
+
+private:
+    static constexpr int kMaxDepth = 64;
+
+    bool finish();
+    void skipWhitespace();
+    bool consume(char expected);
+    bool consumeWord(std::string_view word);
+    bool parseValue(Value& value, int depth);
+    bool parseNumber(Value& value);
+    bool skipContainer(int depth);
+
+    // Finds the end of a string and validates its escapes without copying
+    bool scanString(Value& value);
+    bool validateEscape();
+    bool hex4(uint32_t& code);
+};
+
+} // namespace Json
+
+// Decodes an /api/generate or /api/analyze body into a request. Analysis
+// requests carry the code under "code", as api_server.py accepts it. An
+// optional "type" field ("generate", "analyze", ...) overrides type.
+bool requestFromJson(std::string_view body, RequestType type, CodeRequest& request,
+                     bool& stream, std::string& error);
+
+// Same shape as api_server.py's APIResponse
+std::string responseToJson(const CodeResponse& response);
+
+// Failure before the engine ran, e.g. an invalid request body
+std::string errorToJson(std::string_view error);
+
+} // namespace AIEngine
+
+#endif // AI_ENGINE_JSON_H
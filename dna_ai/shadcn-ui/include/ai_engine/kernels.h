@@ -0,0 +1,27 @@
+/*
+AI Engine - Hot kernels
+Built once per x86-64 microarchitecture level and dispatched at load time
+(see make no-multiversion)
+*/
+
+#ifndef AI_ENGINE_KERNELS_H
+#define AI_ENGINE_KERNELS_H
+
+#include <cstddef>
+
+namespace AIEngine {
+namespace Kernels {
+
+// Microarchitecture level the multiversioned kernels run at on this CPU
+const char* isaLevel();
+
+// Dot product of a and b over n floats, the inner loop of every layer
+float dot(const float* a, const float* b, size_t n);
+
+// ASCII-lowercases n bytes of data in place; other bytes are unchanged
+void toLower(char* data, size_t n);
+
+} // namespace Kernels
+} // namespace AIEngine
+
+#endif // AI_ENGINE_KERNELS_H
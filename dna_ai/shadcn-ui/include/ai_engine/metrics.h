@@ -0,0 +1,341 @@
+/*
+AI Engine - Metrics
+Latency histograms and request counters. Each thread records into its
+own shard, so the hot path is a few relaxed stores with no locks and no
+shared cache lines; readers merge all shards into a Snapshot.
+*/
+
+#ifndef AI_ENGINE_METRICS_H
+#define AI_ENGINE_METRICS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ai_engine/types.h"
+
+namespace AIEngine {
+namespace Metrics {
+
+enum class Stage {
+    QUEUE,      // accepted by a transport until a worker picks it up
+    TOKENIZE,
+    FORWARD,
+    DECODE,
+    FORMAT,
+    TOTAL,      // inside processRequest
+    COUNT
+};
+
+constexpr size_t kStageCount = static_cast<size_t>(Stage::COUNT);
+constexpr size_t kRequestTypeCount = 4;
+
+inline const char* stageName(Stage stage) {
+    switch (stage) {
+        case Stage::QUEUE: return "queue";
+        case Stage::TOKENIZE: return "tokenize";
+        case Stage::FORWARD: return "forward";
+        case Stage::DECODE: return "decode";
+        case Stage::FORMAT: return "format";
+        case Stage::TOTAL: return "total";
+        default: return "unknown";
+    }
+}
+
+inline const char* requestTypeName(RequestType type) {
+    switch (type) {
+        case RequestType::GENERATE_CODE: return "generate";
+        case RequestType::ANALYZE_CODE: return "analyze";
+        case RequestType::EXECUTE_CODE: return "execute";
+        case RequestType::OPTIMIZE_CODE: return "optimize";
+        default: return "unknown";
+    }
+}
+
+// HDR-style log-linear buckets over nanoseconds: exact below 64 ns, then
+// 32 sub-buckets per power of two (at most ~3% relative error) up to
+// 2^36 ns (about 68 s); larger values land in the last bucket
+struct Buckets {
+    static constexpr unsigned kSubBits = 5;
+    static constexpr unsigned kMaxBits = 36;
+    static constexpr size_t kCount = (kMaxBits - kSubBits) * (size_t(1) << kSubBits) + (size_t(1) << (kSubBits + 1));
+
+    static size_t index(uint64_t nanoseconds) {
+        if (nanoseconds < (uint64_t(1) << (kSubBits + 1))) return static_cast<size_t>(nanoseconds);
+        unsigned exponent = 63 - static_cast<unsigned>(__builtin_clzll(nanoseconds));
+        if (exponent > kMaxBits) return kCount - 1;
+        unsigned shift = exponent - kSubBits;
+        return (static_cast<size_t>(shift) << kSubBits) + static_cast<size_t>(nanoseconds >> shift);
+    }
+
+    // Upper bound of the values counted in bucket i
+    static uint64_t upperBound(size_t i) {
+        if (i < (size_t(1) << (kSubBits + 1))) return i;
+        size_t shift = (i >> kSubBits) - 1;
+        uint64_t mantissa = (i & ((size_t(1) << kSubBits) - 1)) | (size_t(1) << kSubBits);
+        return ((mantissa + 1) << shift) - 1;
+    }
+};
+
+// Hardware counters sampled around each stage when enabled with
+// enableHardwareCounters(); each thread opens its own perf_event group
+enum class Counter {
+    CYCLES,
+    INSTRUCTIONS,
+    CACHE_MISSES,
+    BRANCH_MISSES,
+    COUNT
+};
+
+constexpr size_t kCounterCount = static_cast<size_t>(Counter::COUNT);
+
+inline const char* counterName(Counter counter) {
+    switch (counter) {
+        case Counter::CYCLES: return "cycles";
+        case Counter::INSTRUCTIONS: return "instructions";
+        case Counter::CACHE_MISSES: return "cache_misses";
+        case Counter::BRANCH_MISSES: return "branch_misses";
+        default: return "unknown";
+    }
+}
+
+// One perf_event group (user space only) counting the calling thread
+class PerfCounterGroup {
+private:
+    int fds[kCounterCount];
+
+public:
+    PerfCounterGroup();
+    ~PerfCounterGroup();
+
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+    bool open(std::string& error);
+    bool read(uint64_t values[kCounterCount]) const;
+    void close();
+};
+
+inline std::atomic<bool>& hardwareCountersFlag() {
+    static std::atomic<bool> flag{false};
+    return flag;
+}
+
+inline bool hardwareCountersEnabled() {
+    return hardwareCountersFlag().load(std::memory_order_relaxed);
+}
+
+// Written by one thread only: plain load + store of relaxed atomics,
+// which readers on other threads may observe at any time
+struct Shard {
+    struct Histogram {
+        std::atomic<uint64_t> counts[Buckets::kCount];
+        std::atomic<uint64_t> sum;
+        std::atomic<uint64_t> max;
+    };
+
+    Histogram histograms[kRequestTypeCount][kStageCount];
+    std::atomic<uint64_t> requests[kRequestTypeCount];
+    std::atomic<uint64_t> errors[kRequestTypeCount];
+
+    // Hardware counter totals, and how many stage runs they cover
+    std::atomic<uint64_t> counters[kRequestTypeCount][kStageCount][kCounterCount];
+    std::atomic<uint64_t> counted[kRequestTypeCount][kStageCount];
+    PerfCounterGroup perf;
+    bool perf_opened = false;
+
+    Shard();
+
+    // Adds other's totals; only for shards no thread writes any more
+    void absorb(const Shard& other);
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t by = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    void record(size_t type, Stage stage, uint64_t nanoseconds) {
+        Histogram& histogram = histograms[type][static_cast<size_t>(stage)];
+        bump(histogram.counts[Buckets::index(nanoseconds)]);
+        bump(histogram.sum, nanoseconds);
+        if (nanoseconds > histogram.max.load(std::memory_order_relaxed)) {
+            histogram.max.store(nanoseconds, std::memory_order_relaxed);
+        }
+    }
+
+    // Opens this thread's counter group on first use; a thread that cannot
+    // open one simply records no counters
+    bool readCounters(uint64_t values[kCounterCount]) {
+        if (!perf_opened) {
+            perf_opened = true;
+            std::string ignored;
+            perf.open(ignored);
+        }
+        return perf.read(values);
+    }
+
+    void recordCounters(size_t type, Stage stage, const uint64_t before[kCounterCount],
+                        const uint64_t after[kCounterCount]) {
+        auto& totals = counters[type][static_cast<size_t>(stage)];
+        for (size_t i = 0; i < kCounterCount; ++i) {
+            bump(totals[i], after[i] - before[i]);
+        }
+        bump(counted[type][static_cast<size_t>(stage)]);
+    }
+};
+
+struct HistogramSnapshot {
+    std::vector<uint64_t> counts = std::vector<uint64_t>(Buckets::kCount, 0);
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+
+    // Nanoseconds at quantile q in [0, 1]; 0 for an empty histogram
+    uint64_t percentile(double q) const;
+};
+
+struct Snapshot {
+    HistogramSnapshot histograms[kRequestTypeCount][kStageCount];
+    uint64_t requests[kRequestTypeCount] = {};
+    uint64_t errors[kRequestTypeCount] = {};
+    uint64_t counters[kRequestTypeCount][kStageCount][kCounterCount] = {};
+    uint64_t counted[kRequestTypeCount][kStageCount] = {};
+    double uptime_seconds = 0.0;
+
+    const HistogramSnapshot& histogram(RequestType type, Stage stage) const {
+        return histograms[static_cast<size_t>(type)][static_cast<size_t>(stage)];
+    }
+};
+
+class Registry {
+private:
+    std::mutex shards_mutex;
+    std::vector<std::unique_ptr<Shard>> shards;  // one per live thread
+    Shard retired;                               // totals of the threads that have exited
+    std::chrono::steady_clock::time_point started;
+
+    // Folds an exiting thread's shard into retired and frees it
+    void retire(Shard* shard);
+
+public:
+    Registry() : started(std::chrono::steady_clock::now()) {}
+
+    // The calling thread's shard; the lock is only taken on first use
+    Shard& local() {
+        // The thread's totals outlive it, its shard and perf_event group do
+        // not: short-lived threads would otherwise grow the registry and
+        // leak fds
+        struct Local {
+            Registry* owner = nullptr;
+            Shard* shard = nullptr;
+            ~Local() {
+                if (shard != nullptr) owner->retire(shard);
+            }
+        };
+        thread_local Local local;
+        if (local.shard == nullptr) {
+            auto owned = std::make_unique<Shard>();
+            local.owner = this;
+            local.shard = owned.get();
+            std::lock_guard<std::mutex> lock(shards_mutex);
+            shards.push_back(std::move(owned));
+        }
+        return *local.shard;
+    }
+
+    Snapshot snapshot();
+};
+
+// Process-wide, like the engine's worker threads that record into it
+inline Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+inline uint64_t elapsedNanoseconds(std::chrono::steady_clock::time_point since) {
+    auto elapsed = std::chrono::steady_clock::now() - since;
+    return static_cast<uint64_t>(std::max<int64_t>(0,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+}
+
+inline void record(RequestType type, Stage stage, uint64_t nanoseconds) {
+    registry().local().record(static_cast<size_t>(type) % kRequestTypeCount, stage, nanoseconds);
+}
+
+inline void countRequest(RequestType type, bool failed) {
+    Shard& shard = registry().local();
+    size_t index = static_cast<size_t>(type) % kRequestTypeCount;
+    Shard::bump(shard.requests[index]);
+    if (failed) Shard::bump(shard.errors[index]);
+}
+
+// Checks on the calling thread that hardware counters can be opened (the
+// kernel, perf_event_paranoid and the hypervisor all have a say), then
+// turns on sampling around every stage
+bool enableHardwareCounters(std::string& error);
+
+// Records the time from construction to destruction as one stage, and the
+// hardware counter deltas over it when those are enabled
+class ScopedStage {
+private:
+    RequestType type;
+    Stage stage;
+    bool counting;
+    uint64_t counters_before[kCounterCount];
+    std::chrono::steady_clock::time_point start;
+
+public:
+    ScopedStage(RequestType request_type, Stage request_stage)
+        : type(request_type), stage(request_stage),
+          counting(hardwareCountersEnabled() && registry().local().readCounters(counters_before)),
+          start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedStage() {
+        uint64_t nanoseconds = elapsedNanoseconds(start);
+        size_t index = static_cast<size_t>(type) % kRequestTypeCount;
+        Shard& shard = registry().local();
+
+        uint64_t counters_after[kCounterCount];
+        if (counting && shard.readCounters(counters_after)) {
+            shard.recordCounters(index, stage, counters_before, counters_after);
+        }
+        shard.record(index, stage, nanoseconds);
+    }
+
+    ScopedStage(const ScopedStage&) = delete;
+    ScopedStage& operator=(const ScopedStage&) = delete;
+};
+
+// Human-readable summary: request rates, then p50/p99/p999/max per
+// request type and stage for every histogram that has samples
+std::string formatReport(const Snapshot& snapshot);
+
+// Process-wide gauges maintained by the worker pools and socket servers
+struct Gauges {
+    std::atomic<int64_t> queued{0};       // tasks waiting for a worker
+    std::atomic<int64_t> active{0};       // tasks running on a worker
+    std::atomic<int64_t> connections{0};  // open daemon and HTTP connections
+    std::atomic<int64_t> workers{0};      // worker threads across all pools
+};
+
+inline Gauges& gauges() {
+    static Gauges instance;
+    return instance;
+}
+
+// Resident and virtual memory of this process, from /proc/self/statm
+bool memoryUsage(uint64_t& resident_bytes, uint64_t& virtual_bytes);
+
+// Prometheus text exposition format (version 0.0.4). Stage histograms are
+// folded from the fine-grained buckets into fixed le bounds in seconds.
+std::string formatPrometheus(const Snapshot& snapshot);
+
+} // namespace Metrics
+} // namespace AIEngine
+
+#endif // AI_ENGINE_METRICS_H
@@ -0,0 +1,133 @@
+/*
+AI Engine - Model
+Tokenizer and the feed-forward network behind neural code generation
+*/
+
+#ifndef AI_ENGINE_MODEL_H
+#define AI_ENGINE_MODEL_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace AIEngine {
+
+class TokenProcessor {
+private:
+    std::map<std::string, int> vocab;
+    std::map<int, std::string> reverse_vocab;
+    int vocab_size;
+
+public:
+    TokenProcessor() : vocab_size(0) {
+        // Initialize basic vocabulary
+        initializeVocab();
+    }
+
+    // Vocabulary restored from vocabulary() of another tokenizer
+    explicit TokenProcessor(const std::vector<std::string>& tokens) : vocab_size(0) {
+        assignVocab(tokens);
+    }
+
+    void initializeVocab();
+    void assignVocab(const std::vector<std::string>& tokens);
+
+    // Token strings in id order
+    std::vector<std::string> vocabulary() const;
+    std::vector<int> tokenize(const std::string& text) const;
+    std::string detokenize(const std::vector<int>& tokens) const;
+
+    // Process-wide tokenizer, built on first use and shared read-only by
+    // every generator
+    static std::shared_ptr<const TokenProcessor> shared();
+};
+
+class NeuralNetwork {
+public:
+    enum class Activation : uint32_t {
+        RELU,
+        SIGMOID,
+        TANH
+    };
+
+    // A layer's parameters: outputs rows of inputs weights, row-major,
+    // and one bias per output
+    struct LayerView {
+        size_t inputs;
+        size_t outputs;
+        Activation activation;
+        const float* weights;
+        const float* biases;
+    };
+
+private:
+    struct Layer {
+        size_t inputs;
+        size_t outputs;
+        Activation kind;
+        float (*activation)(float);
+        const float* weights;
+        const float* biases;
+        std::vector<float> storage;  // owns weights and biases unless they are borrowed
+
+        // Xavier-initialised weights and biases
+        Layer(int input_size, int output_size, Activation act);
+        // Weights and biases borrowed from memory the network keeps alive
+        explicit Layer(const LayerView& view);
+
+        Layer(const Layer&) = delete;
+        Layer& operator=(const Layer&) = delete;
+        Layer(Layer&&) = default;
+        Layer& operator=(Layer&&) = default;
+
+        const float* row(size_t output) const { return weights + output * inputs; }
+    };
+
+    std::vector<Layer> layers;
+    std::shared_ptr<const void> backing;  // e.g. the snapshot mapping borrowed weights live in
+
+    static float relu(float x) { return std::max(0.0f, x); }
+    static float sigmoid(float x) { return 1.0f / (1.0f + std::exp(-x)); }
+    static float tanh_activation(float x) { return std::tanh(x); }
+    static float (*activationFunction(Activation kind))(float);
+
+    std::vector<float> forwardLayers(const std::vector<float>& input, bool skip_hidden) const;
+
+public:
+    NeuralNetwork();
+
+    // Network over existing parameters, which stay owned by backing
+    NeuralNetwork(const std::vector<LayerView>& views, std::shared_ptr<const void> backing);
+
+    std::vector<LayerView> layerViews() const;
+
+    std::vector<float> forward(const std::vector<float>& input) const;
+
+    // Early exit: the input and output layers only, skipping the hidden
+    // layers that keep the width; the cheaper, coarser model the router
+    // falls back to under load
+    std::vector<float> forwardShallow(const std::vector<float>& input) const;
+
+    // Same results as calling forward() on each input, but the weights are
+    // streamed once per block of inputs instead of once per input; a block
+    // of activations stays in L1 while every weight row passes over it
+    std::vector<std::vector<float>> forwardBatch(const std::vector<std::vector<float>>& inputs) const;
+
+    // Process-wide network, initialised on first use and shared read-only by
+    // every generator, so extra engine instances do not re-initialise weights
+    static std::shared_ptr<const NeuralNetwork> shared();
+
+    // Makes network and tokenizer the process-wide instances, which must
+    // match; false, installing neither, if either is in use already
+    static bool installShared(std::shared_ptr<const NeuralNetwork> network,
+                              std::shared_ptr<const TokenProcessor> tokenizer);
+};
+
+} // namespace AIEngine
+
+#endif // AI_ENGINE_MODEL_H
@@ -0,0 +1,55 @@
+/*
+AI Engine - Prompt features
+Everything the generator decides from a prompt, gathered in one pass: the
+prompt is lowercased in place (SIMD) and every keyword is matched by one
+Aho-Corasick automaton
+*/
+
+#ifndef AI_ENGINE_PROMPT_H
+#define AI_ENGINE_PROMPT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace AIEngine {
+
+enum class PromptKeyword : uint8_t {
+    // Action words, in the order function names prefer them
+    CALCULATE,
+    COMPUTE,
+    FIND,
+    SORT,
+    SEARCH,
+    CREATE,
+    GENERATE,
+    PROCESS,
+    CONVERT,
+    PARSE,
+    // Return type hints
+    COUNT,
+    NUMBER,
+    STRING,
+    TEXT,
+    KEYWORD_COUNT
+};
+
+struct PromptFeatures {
+    std::string lowered;    // the prompt, ASCII-lowercased
+    uint32_t keywords = 0;  // bit per PromptKeyword occurring anywhere, also inside words
+    size_t length = 0;
+
+    bool has(PromptKeyword keyword) const {
+        return (keywords >> static_cast<unsigned>(keyword)) & 1u;
+    }
+
+    // Most preferred action word in the prompt, or empty
+    std::string_view action() const;
+};
+
+PromptFeatures analyzePrompt(std::string_view prompt);
+
+} // namespace AIEngine
+
+#endif // AI_ENGINE_PROMPT_H
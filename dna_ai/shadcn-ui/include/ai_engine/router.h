@@ -0,0 +1,97 @@
+/*
+AI Engine - Generation router
+Chooses how a request is generated: from a template, with the shallow
+(early-exit) network or with the full network. Each path has an expected
+quality for the prompt and a cost, its measured latency; the router picks
+the path with the best quality net of what its cost does to queueing at
+the current load, so it gives up quality for latency as the workers fill
+and serves only templates once they are saturated.
+*/
+
+#ifndef AI_ENGINE_ROUTER_H
+#define AI_ENGINE_ROUTER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ai_engine/prompt.h"
+#include "ai_engine/types.h"
+
+namespace AIEngine {
+
+enum class GenerationPath : uint8_t {
+    TEMPLATE,
+    SMALL_NETWORK,
+    LARGE_NETWORK,
+    COUNT
+};
+
+const char* generationPathName(GenerationPath path);
+
+struct RouteDecision {
+    GenerationPath path;
+    float quality;     // expected quality of the path, 0 to 1
+    double cost_us;    // expected worker time of the path
+};
+
+class Router {
+public:
+    static constexpr size_t kPathCount = static_cast<size_t>(GenerationPath::COUNT);
+
+private:
+    // Moving averages of measured latency, seeded with typical figures so
+    // that paths not taken yet still have a cost
+    std::array<std::atomic<double>, kPathCount> costs;
+    std::array<std::atomic<uint64_t>, kPathCount> routed;
+    std::atomic<bool> load_aware{true};
+
+public:
+    Router();
+
+    Router(const Router&) = delete;
+    Router& operator=(const Router&) = delete;
+
+    // Expected quality of each path for a request; the full network is
+    // never worse than the shallow one, and templates are best for short
+    // prompts without much context
+    static std::array<float, kPathCount> estimateQuality(const CodeRequest& request,
+                                                         const PromptFeatures& features);
+
+    // Busy workers over all workers, from the pool gauges, leaving out the
+    // caller's own slot when it holds one: 0 when idle, 1 or more when
+    // saturated
+    static double currentLoad(bool holds_slot);
+
+    RouteDecision route(const CodeRequest& request, const PromptFeatures& features, double load);
+    // At the current load; holds_slot is whether the caller runs on a pool
+    // worker, as transport requests do and in-process callers do not
+    RouteDecision route(const CodeRequest& request, const PromptFeatures& features, bool holds_slot) {
+        return route(request, features,
+                     load_aware.load(std::memory_order_relaxed) ? currentLoad(holds_slot) : 0.0);
+    }
+
+    // Off for work that queues by design and is measured by throughput
+    // rather than latency, such as a batch: every request is routed as if
+    // the workers were idle
+    void setLoadAware(bool enabled) { load_aware.store(enabled, std::memory_order_relaxed); }
+
+    // Folds a measured latency into the path's cost
+    void record(GenerationPath path, double microseconds);
+
+    double cost(GenerationPath path) const;
+    uint64_t routedCount(GenerationPath path) const;
+
+    // Requests routed and current cost per path, in the Prometheus text
+    // format, to follow formatPrometheus() on /metrics
+    std::string formatPrometheus() const;
+
+    // Process-wide router, so every generator learns from the same costs
+    static Router& shared();
+};
+
+} // namespace AIEngine
+
+#endif // AI_ENGINE_ROUTER_H
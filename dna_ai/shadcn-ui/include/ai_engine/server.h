@@ -0,0 +1,54 @@
+/*
+AI Engine - Engine server
+Dispatches requests to the generator and analyzer and records their
+metrics; every transport and embedder goes through processRequest().
+Construction is cheap: the generator and analyzer are created by the first
+request that needs them.
+*/
+
+#ifndef AI_ENGINE_SERVER_H
+#define AI_ENGINE_SERVER_H
+
+#include <memory>
+#include <mutex>
+
+#include "ai_engine/analyzer.h"
+#include "ai_engine/generator.h"
+#include "ai_engine/metrics.h"
+#include "ai_engine/types.h"
+
+namespace AIEngine {
+
+class AIEngineServer {
+private:
+    std::unique_ptr<CodeGenerator> generator;
+    std::unique_ptr<CodeAnalyzer> analyzer;
+    std::once_flag generator_once;
+    std::once_flag analyzer_once;
+    bool running;
+
+public:
+    AIEngineServer();
+
+    void start();
+    void stop();
+
+    // Generator and analyzer are read-only once constructed, so requests
+    // from several worker threads are processed concurrently without locking;
+    // only their one-time construction is serialised
+    CodeResponse processRequest(const CodeRequest& request);
+
+    // Aggregated latency histograms and counters of every engine instance
+    static Metrics::Snapshot metrics();
+
+private:
+    CodeGenerator& codeGenerator();
+    CodeAnalyzer& codeAnalyzer();
+
+    CodeResponse dispatchRequest(const CodeRequest& request);
+    CodeResponse analyzeCodeRequest(const CodeRequest& request);
+};
+
+} // namespace AIEngine
+
+#endif // AI_ENGINE_SERVER_H
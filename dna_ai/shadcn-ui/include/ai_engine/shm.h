@@ -0,0 +1,104 @@
+/*
+AI Engine - Shared memory transport
+A POSIX shared memory segment holding a request ring and a response ring,
+each a single-producer/single-consumer byte ring whose sides sleep on
+futexes. Requests and responses use the Wire payload encoding.
+*/
+
+#ifndef AI_ENGINE_SHM_H
+#define AI_ENGINE_SHM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "ai_engine/server.h"
+#include "ai_engine/types.h"
+#include "ai_engine/worker_pool.h"
+
+namespace AIEngine {
+
+class ShmChannel;
+
+// Serves requests arriving on a shared memory channel. One thread consumes
+// the request ring and decodes each request in place; workers process them
+// and take turns producing into the response ring.
+class ShmServer {
+private:
+    static constexpr int kPollMs = 100;
+    static constexpr int kResponseTimeoutMs = 30000;
+
+    AIEngineServer& engine;
+    std::unique_ptr<ShmChannel> channel;
+    std::atomic<bool> stopping;
+    std::mutex response_mutex;
+
+    // Declared last so workers drain before the channel is unmapped
+    std::unique_ptr<WorkerPool> pool;
+
+public:
+    static constexpr uint64_t kDefaultRingCapacity = 8u * 1024 * 1024;
+
+    ShmServer(AIEngineServer& engine_ref, const std::string& name, size_t worker_count,
+              uint64_t ring_capacity = kDefaultRingCapacity);
+    ~ShmServer();
+
+    // Safe to call from any thread or from a signal handler
+    void requestStop();
+
+    void run();
+
+private:
+    void dispatch(const char* payload, size_t length);
+};
+
+// Client for ShmServer. Safe to call from several threads: requests are
+// encoded straight into the request ring under a lock, and whichever waiting
+// thread is free reads the next response and hands it to its owner.
+class ShmClient {
+private:
+    static constexpr int kPollMs = 100;
+    // Request ids are the attach epoch above a per-client sequence number
+    static constexpr unsigned kEpochShift = 20;
+    static constexpr uint32_t kSequenceMask = (1u << kEpochShift) - 1;
+
+    std::unique_ptr<ShmChannel> channel;
+    std::mutex send_mutex;
+    std::mutex receive_mutex;
+    std::condition_variable receive_cv;
+    bool reader_active;
+    std::unordered_set<uint32_t> pending;  // ids a caller is still waiting for
+    std::unordered_map<uint32_t, CodeResponse> ready;
+    uint32_t next_request_id;
+
+public:
+    explicit ShmClient(const std::string& name);
+    ~ShmClient();
+
+    CodeResponse processRequest(const CodeRequest& request, int timeout_ms = 30000) {
+        return process(request.type, request.language, request.max_tokens, request.temperature,
+                       request.prompt, request.context, timeout_ms);
+    }
+
+    // Prompt and context are copied once, directly into shared memory
+    CodeResponse process(RequestType type, Language language, int max_tokens, float temperature,
+                         std::string_view prompt, std::string_view context, int timeout_ms = 30000);
+
+private:
+    uint32_t send(RequestType type, Language language, int max_tokens, float temperature,
+                  std::string_view prompt, std::string_view context, int timeout_ms);
+
+    // Called by at most one thread at a time
+    bool receiveOne();
+};
+
+} // namespace AIEngine
+
+#endif // AI_ENGINE_SHM_H
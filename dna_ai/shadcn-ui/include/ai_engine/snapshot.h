@@ -0,0 +1,42 @@
+/*
+AI Engine - Snapshots
+The warmed shared state of an engine process (network weights, tokenizer
+vocabulary, templates) in one file. Weights are stored 64-byte aligned in
+the layout NeuralNetwork computes on, so a new process maps the file and
+serves from it without initialising anything.
+*/
+
+#ifndef AI_ENGINE_SNAPSHOT_H
+#define AI_ENGINE_SNAPSHOT_H
+
+#include <memory>
+#include <string>
+
+#include "ai_engine/generator.h"
+#include "ai_engine/model.h"
+
+namespace AIEngine {
+namespace Snapshot {
+
+struct State {
+    std::shared_ptr<const NeuralNetwork> network;  // weights borrowed from the mapping
+    std::shared_ptr<const TokenProcessor> tokenizer;
+    std::shared_ptr<const TemplateLibrary> templates;
+};
+
+// Writes the process's shared state, building whatever is not yet, to path
+// (through a temporary file, so readers never see a partial snapshot)
+void save(const std::string& path);
+
+// Maps a snapshot and checks its layout; throws std::runtime_error when the
+// file is missing, truncated or from an incompatible build
+State load(const std::string& path);
+
+// load() and install the result as the process-wide shared state; must run
+// before the first request, otherwise it throws
+void restore(const std::string& path);
+
+} // namespace Snapshot
+} // namespace AIEngine
+
+#endif // AI_ENGINE_SNAPSHOT_H
@@ -0,0 +1,162 @@
+/*
+AI Engine - Socket transports
+Event loop owning a listening socket and its connections, on top of an
+IoBackend. Subclasses parse the bytes arriving on a connection and hand
+work to the worker pool; finished work is posted back and written by the
+loop thread. With ordered_responses, replies are written in request
+order (as HTTP requires) even though workers may finish them out of order.
+*/
+
+#ifndef AI_ENGINE_SOCKET_SERVER_H
+#define AI_ENGINE_SOCKET_SERVER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ai_engine/io_backend.h"
+#include "ai_engine/server.h"
+#include "ai_engine/worker_pool.h"
+
+namespace AIEngine {
+
+class SocketServer : private IoBackend::Handler {
+protected:
+    struct Connection {
+        std::string input;
+        std::string output;           // queued behind the send in progress
+        std::string sending;          // owned by the backend until onSent
+        size_t in_flight = 0;
+        uint64_t next_sequence = 0;   // assigned to each reply in request order
+        uint64_t next_to_write = 0;   // ordered mode: next reply to append
+        std::map<uint64_t, std::string> held;  // ordered mode: finished early
+        uint32_t protocol_state = 0;  // free for use by subclasses
+        bool peer_closed = false;
+        bool input_paused = false;
+        size_t resume_at = 0;         // in_flight at which paused input resumes
+    };
+
+    AIEngineServer& engine;
+
+private:
+    struct Completion {
+        uint64_t connection_id;
+        uint64_t sequence;
+        std::string bytes;
+    };
+
+    int listen_fd;
+    bool ordered_responses;
+    uint64_t next_connection_id;
+    std::unordered_map<uint64_t, Connection> connections;
+    std::unique_ptr<IoBackend> backend;
+
+    std::mutex completed_mutex;
+    std::vector<Completion> completed;
+
+    // Declared last so it is destroyed first: workers finish posting while
+    // the rest of the server is still alive
+    std::unique_ptr<WorkerPool> pool;
+
+public:
+    SocketServer(AIEngineServer& engine_ref, int listening_fd, size_t worker_count,
+                 IoBackendKind backend_kind, bool ordered = false);
+    ~SocketServer() override;
+
+    SocketServer(const SocketServer&) = delete;
+    SocketServer& operator=(const SocketServer&) = delete;
+
+    const char* backendName() const { return backend->name(); }
+
+    // Safe to call from any thread or from a signal handler
+    void requestStop() {
+        backend->stop();
+    }
+
+    void run() {
+        backend->run(*this);
+    }
+
+protected:
+    // Consume complete messages from conn.input; return false on a protocol error
+    virtual bool onInput(uint64_t connection_id, Connection& conn) = 0;
+
+    // Called for each accepted socket, e.g. to set socket options
+    virtual void onAccept(int) {}
+
+    // Run job on a worker and write the bytes it returns to the connection
+    void submit(uint64_t connection_id, Connection& conn, std::function<std::string()> job);
+
+    // Queue a reply produced on the loop thread, in order with submitted work
+    void reply(Connection& conn, std::string bytes) {
+        deliver(conn, conn.next_sequence++, std::move(bytes));
+    }
+
+    // Nothing more is read from the connection; it closes once every
+    // outstanding reply has been written
+    void closeWhenDone(uint64_t id, Connection& conn);
+
+    // Stops reading from the connection until no more than resume_at
+    // requests are in flight, then reads again and calls onInput() for
+    // what is still buffered in conn.input
+    void pauseInput(uint64_t id, Connection& conn, size_t resume_at);
+
+    bool hasPendingReplies(const Connection& conn) const {
+        return conn.in_flight > 0 || !conn.output.empty() || !conn.sending.empty();
+    }
+
+    // Bytes written ahead of every queued reply, e.g. HTTP 100 Continue;
+    // only valid while hasPendingReplies() is false
+    void sendInterim(Connection& conn, const std::string& bytes) {
+        conn.output.append(bytes);
+    }
+
+private:
+    void onAccepted(int fd) override;
+    void onReceived(uint64_t id, const char* data, size_t size) override;
+    void onSent(uint64_t id) override;
+    void onFailed(uint64_t id) override;
+    void onWake() override;
+
+    void resumeInput(uint64_t id, Connection& conn);
+    void deliver(Connection& conn, uint64_t sequence, std::string bytes);
+    void post(uint64_t connection_id, uint64_t sequence, std::string bytes);
+
+    // Starts the next send if none is in progress, or closes a finished
+    // half-closed connection
+    void flush(uint64_t id, Connection& conn);
+    void closeConnection(uint64_t id);
+};
+
+// Serves the length-prefixed binary protocol (see Wire) on a Unix domain socket
+class DaemonServer : public SocketServer {
+public:
+    DaemonServer(AIEngineServer& engine_ref, const std::string& socket_path, size_t worker_count,
+                 IoBackendKind backend_kind = IoBackendKind::AUTO)
+        : SocketServer(engine_ref, openUnixSocket(socket_path), worker_count, backend_kind),
+          path(socket_path) {}
+
+    ~DaemonServer() override;
+
+    static int openUnixSocket(const std::string& socket_path);
+
+protected:
+    bool onInput(uint64_t connection_id, Connection& conn) override;
+
+private:
+    // Requests a connection may have queued or running; its input is not
+    // read past them, so one client cannot fill the worker queue
+    static constexpr size_t kMaxInFlight = 64;
+
+    std::string path;
+};
+
+} // namespace AIEngine
+
+#endif // AI_ENGINE_SOCKET_SERVER_H
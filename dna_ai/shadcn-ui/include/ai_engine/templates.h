@@ -0,0 +1,141 @@
+/*
+AI Engine - Compiled templates
+A code template parsed once into literal segments and placeholder slots,
+so generation renders it in one pass into an exactly sized buffer, and the
+library of named templates per language the generator selects from
+*/
+
+#ifndef AI_ENGINE_TEMPLATES_H
+#define AI_ENGINE_TEMPLATES_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ai_engine/types.h"
+
+namespace AIEngine {
+
+class CompiledTemplate {
+public:
+    // Placeholders the generator fills; any other {name} stays literal text
+    enum class Slot : uint8_t {
+        FUNCTION_NAME,
+        CLASS_NAME,
+        DESCRIPTION,
+        BODY,
+        PARAMS,
+        RETURN_TYPE,
+        MAIN_BODY,
+        COUNT,
+        NONE = COUNT
+    };
+
+    static constexpr size_t kSlotCount = static_cast<size_t>(Slot::COUNT);
+    using Values = std::array<std::string_view, kSlotCount>;
+
+private:
+    // A run of source text followed by a slot (NONE after the last run)
+    struct Segment {
+        uint32_t offset;
+        uint32_t length;
+        Slot slot;
+    };
+
+    std::string text;
+    std::vector<Segment> segments;
+    size_t literal_size;
+    uint32_t used_slots;
+
+public:
+    explicit CompiledTemplate(std::string source);
+
+    const std::string& source() const { return text; }
+    // The source text between placeholders
+    std::vector<std::string_view> literals() const;
+    bool uses(Slot slot) const { return (used_slots >> static_cast<unsigned>(slot)) & 1u; }
+
+    // values holds the text of each slot the template uses
+    std::string render(const Values& values) const;
+
+    static Slot slotNamed(std::string_view name);
+};
+
+// Immutable once built: the generator swaps in a new library instead of
+// changing the one requests are rendering from.
+//
+// Each language has an inverted index from keywords to the templates they
+// occur in (words of the template name weigh more than words of its text)
+// and a hashed character-trigram embedding of every template's keywords,
+// clustered around about sqrt(n) centroids. select() scores only the
+// templates sharing a keyword with the prompt and those in the clusters
+// nearest to it, scanning neither the whole library nor template text.
+class TemplateLibrary {
+public:
+    static constexpr size_t kEmbeddingSize = 64;
+
+    struct Template {
+        std::string name;
+        CompiledTemplate compiled;
+    };
+
+private:
+    static constexpr size_t kLanguageCount = static_cast<size_t>(Language::UNKNOWN) + 1;
+
+    struct Posting {
+        uint32_t index;
+        float weight;
+    };
+
+    struct Index {
+        std::unordered_map<std::string, std::vector<Posting>> postings;
+        std::vector<float> embeddings;  // kEmbeddingSize floats per template, unit length
+
+        // Approximate nearest neighbours: every template is in the cluster
+        // of its nearest centroid. The centroids are fitted again whenever
+        // the template count has doubled since they last were.
+        std::vector<float> centroids;                 // kEmbeddingSize floats per cluster, unit length
+        std::vector<std::vector<uint32_t>> clusters;  // template positions per centroid
+        size_t clustered = 0;                         // templates when the centroids were fitted
+    };
+
+    std::array<std::vector<Template>, kLanguageCount> by_language;
+    std::array<std::map<std::string, size_t, std::less<>>, kLanguageCount> by_name;
+    std::array<Index, kLanguageCount> indexes;
+    size_t count = 0;
+
+    void indexTemplate(Index& index, uint32_t position, const Template& entry);
+    static void fitClusters(Index& index, size_t templates);
+    static size_t nearestCentroid(const Index& index, const float* embedding);
+
+public:
+    // Adds a template, replacing one of the same name and language
+    void add(Language language, std::string name, std::string source);
+
+    const std::vector<Template>& templates(Language language) const;
+    const CompiledTemplate* find(Language language, std::string_view name) const;
+    size_t size() const { return count; }
+
+    // Template of language best matching prompt by keywords and embedding
+    // similarity; nullptr when nothing is close enough
+    const CompiledTemplate* select(Language language, std::string_view prompt) const;
+
+    // Unit-length hashed character-trigram embedding of weighted words
+    static void embed(const std::vector<std::pair<std::string, float>>& words, float* out);
+
+    // Reads every file PATH/<language>/<name>[.ext], where <language> is a
+    // name stringToLanguage() accepts; throws std::runtime_error if the
+    // directory or a file cannot be read
+    static TemplateLibrary loadDirectory(const std::string& path);
+};
+
+} // namespace AIEngine
+
+#endif // AI_ENGINE_TEMPLATES_H
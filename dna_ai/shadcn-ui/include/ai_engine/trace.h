@@ -0,0 +1,137 @@
+/*
+AI Engine - Tracing
+Tracing spans around the hot stages. AI_TRACE_SCOPE("name") records the
+enclosing scope into a per-thread ring buffer while tracing is enabled
+at run time; building with -DAI_ENGINE_NO_TRACE removes the spans
+entirely. Trace::exportChrome() renders the buffers as Chrome trace
+JSON, viewable in chrome://tracing or ui.perfetto.dev.
+*/
+
+#ifndef AI_ENGINE_TRACE_H
+#define AI_ENGINE_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace AIEngine {
+namespace Trace {
+
+inline std::atomic<bool>& enabledFlag() {
+    static std::atomic<bool> flag{false};
+    return flag;
+}
+
+inline bool enabled() {
+    return enabledFlag().load(std::memory_order_relaxed);
+}
+
+inline void setEnabled(bool on) {
+    enabledFlag().store(on, std::memory_order_relaxed);
+}
+
+inline uint64_t nowNanoseconds() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Single-writer ring of the most recent spans of one thread. Fields are
+// relaxed atomics so an exporter may copy them while the owner writes;
+// like a seqlock, the writer announces a slot through claimed before
+// filling it, and entries overwritten during a copy are dropped.
+class Ring {
+public:
+    static constexpr size_t kCapacity = 16384;
+
+    struct Event {
+        std::atomic<const char*> name{nullptr};  // string literal
+        std::atomic<uint64_t> start{0};
+        std::atomic<uint64_t> duration{0};
+    };
+
+    struct Copy {
+        const char* name;
+        uint64_t start;
+        uint64_t duration;
+    };
+
+    explicit Ring(long thread_id) : tid(thread_id), events(new Event[kCapacity]) {}
+
+    void record(const char* name, uint64_t start, uint64_t duration) {
+        uint64_t index = head.load(std::memory_order_relaxed);
+        claimed.store(index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        Event& event = events[index & (kCapacity - 1)];
+        event.name.store(name, std::memory_order_relaxed);
+        event.start.store(start, std::memory_order_relaxed);
+        event.duration.store(duration, std::memory_order_relaxed);
+        head.store(index + 1, std::memory_order_release);
+    }
+
+    void copyTo(std::vector<Copy>& out) const;
+
+    long threadId() const { return tid; }
+
+private:
+    long tid;
+    std::atomic<uint64_t> head{0};     // events completely written
+    std::atomic<uint64_t> claimed{0};  // events started
+    std::unique_ptr<Event[]> events;
+};
+
+class Registry {
+private:
+    std::mutex rings_mutex;
+    std::vector<std::unique_ptr<Ring>> rings;  // kept after their thread exits
+
+public:
+    // The calling thread's ring, created on first use
+    Ring& local();
+    std::string exportChrome();
+};
+
+inline Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+// Every thread's recorded spans as Chrome trace JSON
+std::string exportChrome();
+
+// Records its lifetime as one complete ("X") event
+class Span {
+private:
+    const char* name;
+    uint64_t start;
+
+public:
+    explicit Span(const char* span_name) : name(span_name), start(enabled() ? nowNanoseconds() : 0) {}
+
+    ~Span() {
+        if (start != 0) {
+            registry().local().record(name, start, nowNanoseconds() - start);
+        }
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+};
+
+} // namespace Trace
+} // namespace AIEngine
+
+#define AI_TRACE_CONCAT_INNER(a, b) a##b
+#define AI_TRACE_CONCAT(a, b) AI_TRACE_CONCAT_INNER(a, b)
+
+#ifdef AI_ENGINE_NO_TRACE
+#define AI_TRACE_SCOPE(name) ((void)sizeof(name))
+#else
+#define AI_TRACE_SCOPE(name) ::AIEngine::Trace::Span AI_TRACE_CONCAT(ai_trace_span_, __LINE__)(name)
+#endif
+
+#endif // AI_ENGINE_TRACE_H
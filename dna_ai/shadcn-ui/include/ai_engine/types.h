@@ -0,0 +1,57 @@
+/*
+AI Engine - Request and response types
+Shared by every component and transport of the engine
+*/
+
+#ifndef AI_ENGINE_TYPES_H
+#define AI_ENGINE_TYPES_H
+
+#include <chrono>
+#include <string>
+
+namespace AIEngine {
+
+enum class Language {
+    PYTHON,
+    CPP,
+    JAVASCRIPT,
+    HTML,
+    CSS,
+    UNKNOWN
+};
+
+enum class RequestType {
+    GENERATE_CODE,
+    ANALYZE_CODE,
+    EXECUTE_CODE,
+    OPTIMIZE_CODE
+};
+
+struct CodeRequest {
+    std::string prompt;
+    Language language;
+    std::string context;
+    int max_tokens = 1000;
+    float temperature = 0.7f;
+    RequestType type = RequestType::GENERATE_CODE;
+    // When a transport received the request, for the queue-wait metric;
+    // left default-constructed by callers that do not queue
+    std::chrono::steady_clock::time_point received_at{};
+};
+
+struct CodeResponse {
+    std::string code;
+    std::string explanation;
+    float confidence;
+    std::string execution_result;
+    std::string error;
+    std::chrono::milliseconds processing_time;
+};
+
+// "python", "py", "cpp", "c++", "js", ... (case-insensitive); UNKNOWN otherwise
+Language stringToLanguage(const std::string& lang_str);
+std::string languageToString(Language lang);
+
+} // namespace AIEngine
+
+#endif // AI_ENGINE_TYPES_H
@@ -0,0 +1,156 @@
+/*
+AI Engine - Wire protocol
+Length-prefixed binary protocol spoken by the engine daemon.
+Every frame is a little-endian uint32 payload length followed by the payload.
+
+Request payload:
+  u32 request_id, u8 type, u8 language, u16 reserved,
+  i32 max_tokens, f32 temperature,
+  u32 prompt length + bytes, u32 context length + bytes
+
+Response payload:
+  u32 request_id, u8 status (0 = ok, 1 = error), u8[3] reserved,
+  f32 confidence, u32 processing_time_ms,
+  then code, explanation, execution_result and error as u32 length + bytes
+
+Type and language use the numeric order of RequestType and Language.
+Responses echo the request_id and may complete out of order, so a client
+can pipeline any number of requests on one connection.
+*/
+
+#ifndef AI_ENGINE_WIRE_H
+#define AI_ENGINE_WIRE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "ai_engine/types.h"
+
+namespace AIEngine {
+namespace Wire {
+
+constexpr size_t kLengthPrefixSize = 4;
+constexpr uint32_t kMaxFrameSize = 64u * 1024 * 1024;
+
+// Writes fields into a buffer already sized for them
+class Writer {
+private:
+    char* out;
+
+public:
+    explicit Writer(char* buffer) : out(buffer) {}
+
+    void putU8(uint8_t value) { *out++ = static_cast<char>(value); }
+
+    void putU16(uint16_t value) {
+        putU8(value & 0xff);
+        putU8(value >> 8);
+    }
+
+    void putU32(uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            putU8((value >> shift) & 0xff);
+        }
+    }
+
+    void putF32(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        putU32(bits);
+    }
+
+    void putString(std::string_view value) {
+        putU32(static_cast<uint32_t>(value.size()));
+        std::memcpy(out, value.data(), value.size());
+        out += value.size();
+    }
+};
+
+class Reader {
+private:
+    const unsigned char* data;
+    size_t size;
+    size_t pos;
+
+public:
+    Reader(const char* buffer, size_t length)
+        : data(reinterpret_cast<const unsigned char*>(buffer)), size(length), pos(0) {}
+
+    bool getU8(uint8_t& value) {
+        if (pos + 1 > size) return false;
+        value = data[pos++];
+        return true;
+    }
+
+    bool getU16(uint16_t& value) {
+        if (pos + 2 > size) return false;
+        value = static_cast<uint16_t>(data[pos] | (data[pos + 1] << 8));
+        pos += 2;
+        return true;
+    }
+
+    bool getU32(uint32_t& value) {
+        if (pos + 4 > size) return false;
+        value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(data[pos + i]) << (8 * i);
+        }
+        pos += 4;
+        return true;
+    }
+
+    bool getF32(float& value) {
+        uint32_t bits;
+        if (!getU32(bits)) return false;
+        std::memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+
+    bool getString(std::string& value) {
+        uint32_t length;
+        if (!getU32(length) || length > size - pos) return false;
+        value.assign(reinterpret_cast<const char*>(data + pos), length);
+        pos += length;
+        return true;
+    }
+
+    bool atEnd() const { return pos == size; }
+};
+
+// Reads the payload length of the frame at the start of buffer, if complete
+inline bool peekFrameLength(const std::string& buffer, size_t offset, uint32_t& length) {
+    if (buffer.size() - offset < kLengthPrefixSize) return false;
+    Reader reader(buffer.data() + offset, kLengthPrefixSize);
+    return reader.getU32(length);
+}
+
+constexpr size_t kRequestFixedSize = 4 + 1 + 1 + 2 + 4 + 4 + 4 + 4;
+constexpr size_t kResponseFixedSize = 4 + 1 + 3 + 4 + 4 + 4 * 4;
+
+inline size_t requestPayloadSize(size_t prompt_size, size_t context_size) {
+    return kRequestFixedSize + prompt_size + context_size;
+}
+
+// Writes a request payload straight into out, which must hold
+// requestPayloadSize() bytes; lets transports encode into their own buffers
+void writeRequestPayload(char* out, uint32_t request_id, RequestType type, Language language,
+                         int max_tokens, float temperature,
+                         std::string_view prompt, std::string_view context);
+
+// Appends a complete frame (length prefix and payload) to out
+void encodeRequest(uint32_t request_id, const CodeRequest& request, std::string& out);
+
+bool decodeRequest(const char* payload, size_t length, uint32_t& request_id, CodeRequest& request);
+
+// Appends a complete frame (length prefix and payload) to out
+void encodeResponse(uint32_t request_id, const CodeResponse& response, std::string& out);
+
+bool decodeResponse(const char* payload, size_t length, uint32_t& request_id, CodeResponse& response);
+
+} // namespace Wire
+} // namespace AIEngine
+
+#endif // AI_ENGINE_WIRE_H
@@ -0,0 +1,50 @@
+/*
+AI Engine - Worker pool
+Fixed-size pool of worker threads that runs engine requests for the
+socket, HTTP and shared memory transports and for batch runs
+*/
+
+#ifndef AI_ENGINE_WORKER_POOL_H
+#define AI_ENGINE_WORKER_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace AIEngine {
+
+class WorkerPool {
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    bool stopping;
+
+public:
+    explicit WorkerPool(size_t thread_count);
+
+    // Drains the queue before joining, so every submitted task runs
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void submit(std::function<void()> task);
+    size_t pending();
+    size_t size() const { return workers.size(); }
+
+    // Whether the calling thread is running a task of some pool, and so
+    // counts itself in the active gauge
+    static bool runningTask();
+
+private:
+    void workerLoop();
+};
+
+} // namespace AIEngine
+
+#endif // AI_ENGINE_WORKER_POOL_H
@@ -0,0 +1,152 @@
+#include "ai_engine/analyzer.h"
+
+#include <algorithm>
+#include <regex>
+
+#include "ai_engine/trace.h"
+
+namespace AIEngine {
+
+CodeAnalyzer::AnalysisResult CodeAnalyzer::analyzeCode(const std::string& code, Language language) {
+    AI_TRACE_SCOPE("analyzeCode");
+    AnalysisResult result;
+
+    {
+        AI_TRACE_SCOPE("analyze.countLines");
+        result.lines_of_code = countLines(code);
+    }
+    {
+        AI_TRACE_SCOPE("analyze.complexity");
+        result.cyclomatic_complexity = calculateComplexity(code, language);
+    }
+    {
+        AI_TRACE_SCOPE("analyze.functions");
+        result.functions = extractFunctions(code, language);
+    }
+    {
+        AI_TRACE_SCOPE("analyze.classes");
+        result.classes = extractClasses(code, language);
+    }
+    {
+        AI_TRACE_SCOPE("analyze.issues");
+        result.issues = findIssues(code, language);
+    }
+    result.maintainability_index = calculateMaintainability(result);
+
+    return result;
+}
+
+int CodeAnalyzer::countLines(const std::string& code) {
+    return std::count(code.begin(), code.end(), '\n') + 1;
+}
+
+int CodeAnalyzer::calculateComplexity(const std::string& code, Language language) {
+    int complexity = 1; // Base complexity
+
+    // Count decision points
+    std::vector<std::string> decision_keywords;
+
+    if (language == Language::CPP) {
+        decision_keywords = {"if", "else", "for", "while", "switch", "case", "catch"};
+    } else if (language == Language::PYTHON) {
+        decision_keywords = {"if", "elif", "else", "for", "while", "except", "and", "or"};
+    } else if (language == Language::JAVASCRIPT) {
+        decision_keywords = {"if", "else", "for", "while", "switch", "case", "catch"};
+    }
+
+    for (const auto& keyword : decision_keywords) {
+        size_t pos = 0;
+        while ((pos = code.find(keyword, pos)) != std::string::npos) {
+            complexity++;
+            pos += keyword.length();
+        }
+    }
+
+    return complexity;
+}
+
+std::vector<std::string> CodeAnalyzer::extractFunctions(const std::string& code, Language language) {
+    std::vector<std::string> functions;
+    std::regex function_regex;
+
+    if (language == Language::CPP) {
+        function_regex = std::regex(R"(\w+\s+(\w+)\s*\([^)]*\)\s*\{)");
+    } else if (language == Language::PYTHON) {
+        function_regex = std::regex(R"(def\s+(\w+)\s*\([^)]*\)\s*:)");
+    } else if (language == Language::JAVASCRIPT) {
+        function_regex = std::regex(R"(function\s+(\w+)\s*\([^)]*\)\s*\{)");
+    }
+
+    std::sregex_iterator iter(code.begin(), code.end(), function_regex);
+    std::sregex_iterator end;
+
+    for (; iter != end; ++iter) {
+        functions.push_back((*iter)[1].str());
+    }
+
+    return functions;
+}
+
+std::vector<std::string> CodeAnalyzer::extractClasses(const std::string& code, Language language) {
+    std::vector<std::string> classes;
+    std::regex class_regex;
+
+    if (language == Language::CPP) {
+        class_regex = std::regex(R"(class\s+(\w+))");
+    } else if (language == Language::PYTHON) {
+        class_regex = std::regex(R"(class\s+(\w+))");
+    } else if (language == Language::JAVASCRIPT) {
+        class_regex = std::regex(R"(class\s+(\w+))");
+    }
+
+    std::sregex_iterator iter(code.begin(), code.end(), class_regex);
+    std::sregex_iterator end;
+
+    for (; iter != end; ++iter) {
+        classes.push_back((*iter)[1].str());
+    }
+
+    return classes;
+}
+
+std::vector<std::string> CodeAnalyzer::findIssues(const std::string& code, Language language) {
+    std::vector<std::string> issues;
+
+    // Check for common issues
+    if (code.find("TODO") != std::string::npos) {
+        issues.push_back("Contains TODO comments");
+    }
+
+    if (code.find("FIXME") != std::string::npos) {
+        issues.push_back("Contains FIXME comments");
+    }
+
+    // Language-specific checks
+    if (language == Language::CPP) {
+        if (code.find("using namespace std;") != std::string::npos) {
+            issues.push_back("Uses 'using namespace std' (not recommended)");
+        }
+    }
+
+    return issues;
+}
+
+float CodeAnalyzer::calculateMaintainability(const AnalysisResult& result) {
+    // Simplified maintainability index calculation
+    float base_score = 100.0f;
+
+    // Penalize high complexity
+    base_score -= result.cyclomatic_complexity * 2.0f;
+
+    // Penalize long files
+    if (result.lines_of_code > 500) {
+        base_score -= (result.lines_of_code - 500) * 0.1f;
+    }
+
+    // Penalize issues
+    base_score -= result.issues.size() * 5.0f;
+
+    return std::max(0.0f, std::min(100.0f, base_score));
+}
+
+} // namespace AIEngine
@@ -0,0 +1,722 @@
+#include "ai_engine/grammar.h"
+
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+
+#include "ai_engine/trace.h"
+
+namespace AIEngine {
+
+namespace {
+
+// What a token does to the parse, decided once per vocabulary entry
+enum class Kind : uint8_t {
+    SPECIAL,      // <pad>, <unk>, <start>: never generated
+    END,          // <end>: stops decoding when proposed in an accepting state
+    OPEN,
+    CLOSE,
+    SEMICOLON,
+    COLON,
+    COMMA,
+    DOT,
+    OPERATOR,     // binary only
+    ASSIGN,       // "=": binary, and starts a declarator's initialiser
+    SIGN,         // binary or unary
+    PREFIX,       // unary only: not, void, typeof, new
+    STATEMENT,    // keyword starting a statement, followed by an expression
+    CONDITIONAL,  // Python "if": a statement or inside an expression
+    BRANCH,       // C++ and JavaScript "if": a condition in parentheses, then the body
+    LOOP,         // while, and C++ switch: likewise
+    FOR,          // C++ and JavaScript "for": three clauses in parentheses, then the body
+    INCLUDE,      // C++ #include: one header, then the line ends
+    USING,        // C++ using-directive
+    BINDING,      // JavaScript var, let: names with optional initialisers
+    CONSTANT,     // JavaScript const: names with initialisers
+    FUNCTION_DEF, // def, function: name, parameter list, body
+    TYPE_DEF,     // class, struct: name, then the body
+    NAMESPACE,    // C++ namespace: name, then a body of declarations
+    TYPE,         // C++ type name, the one a declaration has
+    QUALIFIER,    // C++ const
+    ELSE,
+    OPERAND,
+    FOREIGN       // keyword of another language, or one the grammar does not model
+};
+
+// What the stack holds. Besides plain brackets, the parentheses and braces
+// that end a construct record which one, for what their close leads to.
+enum Bracket : uint8_t {
+    PAREN,
+    SQUARE,
+    BRACE,            // a block, or a Python dict or set
+    CONDITION,        // of while or switch, or the last clause of a for header
+    BRANCH_CONDITION, // of if
+    FOR_INIT,         // first clause of a for header
+    FOR_TEST,         // second clause
+    BRANCH_BLOCK,     // braced body of an if, which an else may follow
+    TYPE_BODY,        // class or struct members
+    NAMESPACE_BODY,
+    NO_BRACKET
+};
+
+// Where the parse is between two tokens
+enum Position : uint8_t {
+    STATEMENT_START,  // may also end the output
+    BLOCK_START,      // a statement must follow: Python after ':', C++ and JavaScript after a loop header or else
+    BRANCH_BODY,      // C++ and JavaScript, after an if condition: a statement, or a block an else may follow
+    AFTER_BRANCH,     // after that block: else, or whatever a statement start allows
+    EXPECT_OPERAND,   // the start of an expression
+    EXPECT_RIGHT,     // after an operator: the rest of an expression
+    OPENED,           // just after an opening bracket: an operand, or the close
+    AFTER_TARGET,     // after a name or member, which may be assigned to
+    AFTER_OPERAND,
+    AFTER_DOT,
+    AFTER_TARGET_DOT,
+    AFTER_ELSE,       // Python, expecting ':'
+    INCLUDED,         // C++, after an #include's header: whatever a statement start allows but ';'
+    // Positions from here on take only the few tokens stepHeader() lists.
+    // Keywords expecting their parenthesis:
+    BRANCH_KEYWORD,
+    LOOP_KEYWORD,
+    FOR_KEYWORD,
+    INCLUDE_TARGET,
+    USING_KEYWORD,
+    USING_NAMESPACE,
+    EXPECT_SEMICOLON, // C++, after a class body or using-directive
+    // C++ declarations: a type name and at most one qualifier, then the
+    // declarators; JavaScript bindings share the later declarators
+    SPECIFIER,        // a type name, no qualifier yet
+    QUALIFIED,        // a qualifier, no type name yet
+    SPECIFIERS,
+    DECLARATOR,       // after the first name: parameters, '=', ',' or ';'
+    NEXT_NAME,
+    NEXT_DECLARATOR,  // after a later name: '=', ',' or ';'
+    CONST_NAME,
+    CONST_DECLARATOR, // JavaScript const, expecting '='
+    // Definition headers. Parameter lists are flat (names, C++ also
+    // types), so they need no bracket on the stack.
+    FUNCTION_NAME,    // after def/function
+    TYPE_NAME,        // after class/struct
+    NAMESPACE_NAME,
+    FUNCTION_NAMED,
+    TYPE_NAMED,       // Python: bases or ':'; C++ and JavaScript: the body
+    NAMESPACE_NAMED,
+    PARAMS_OPEN,
+    PARAM_QUALIFIED,  // C++, a parameter's qualifier
+    PARAM_TYPE,       // C++, a parameter's type name
+    PARAM_TYPES,      // C++, both
+    PARAM,
+    PARAM_NEXT,
+    HEADER_END,       // after the parameter list: ':' or the body
+    POSITION_COUNT
+};
+
+enum class Flavor : uint8_t { PYTHON, CPP, JAVASCRIPT, GENERIC };
+
+struct TokenClass {
+    Kind kind;
+    Bracket bracket;
+};
+
+bool isOneOf(const std::string& token, std::initializer_list<const char*> words) {
+    for (const char* word : words) {
+        if (token == word) return true;
+    }
+    return false;
+}
+
+Flavor flavorOf(Language language) {
+    switch (language) {
+        case Language::PYTHON: return Flavor::PYTHON;
+        case Language::CPP: return Flavor::CPP;
+        case Language::JAVASCRIPT: return Flavor::JAVASCRIPT;
+        default: return Flavor::GENERIC;
+    }
+}
+
+TokenClass classify(const std::string& token, Flavor flavor) {
+    if (token.empty()) return {Kind::SPECIAL, NO_BRACKET};
+    if (token == "<end>") return {Kind::END, NO_BRACKET};
+    if (token.size() > 2 && token.front() == '<' && token.back() == '>') return {Kind::SPECIAL, NO_BRACKET};
+
+    if (token == "(") return {Kind::OPEN, PAREN};
+    if (token == "[") return {Kind::OPEN, SQUARE};
+    if (token == "{") return {Kind::OPEN, BRACE};
+    if (token == ")") return {Kind::CLOSE, PAREN};
+    if (token == "]") return {Kind::CLOSE, SQUARE};
+    if (token == "}") return {Kind::CLOSE, BRACE};
+    if (token == ";") return {Kind::SEMICOLON, NO_BRACKET};
+    if (token == ":") return {Kind::COLON, NO_BRACKET};
+    if (token == ",") return {Kind::COMMA, NO_BRACKET};
+    if (token == ".") return {Kind::DOT, NO_BRACKET};
+    if (token == "+" || token == "-") return {Kind::SIGN, NO_BRACKET};
+    if (token == "=") return {Kind::ASSIGN, NO_BRACKET};
+    if (token.find_first_not_of("+-*/%=<>!&|^~") == std::string::npos) return {Kind::OPERATOR, NO_BRACKET};
+    if (token == "else") return {Kind::ELSE, NO_BRACKET};
+
+    switch (flavor) {
+        case Flavor::PYTHON:
+            if (token == "if") return {Kind::CONDITIONAL, NO_BRACKET};
+            if (token == "def") return {Kind::FUNCTION_DEF, NO_BRACKET};
+            if (token == "class") return {Kind::TYPE_DEF, NO_BRACKET};
+            if (isOneOf(token, {"elif", "for", "while", "return", "import", "from", "with",
+                                "raise", "assert", "del", "global"})) {
+                return {Kind::STATEMENT, NO_BRACKET};
+            }
+            if (isOneOf(token, {"and", "or", "in", "is"})) return {Kind::OPERATOR, NO_BRACKET};
+            if (token == "not") return {Kind::PREFIX, NO_BRACKET};
+            if (isOneOf(token, {"#include", "using", "namespace", "function", "var", "let", "const"})) {
+                return {Kind::FOREIGN, NO_BRACKET};
+            }
+            break;
+        case Flavor::CPP:
+            if (token == "if") return {Kind::BRANCH, NO_BRACKET};
+            if (token == "while" || token == "switch") return {Kind::LOOP, NO_BRACKET};
+            if (token == "for") return {Kind::FOR, NO_BRACKET};
+            if (token == "#include") return {Kind::INCLUDE, NO_BRACKET};
+            if (token == "using") return {Kind::USING, NO_BRACKET};
+            if (token == "namespace") return {Kind::NAMESPACE, NO_BRACKET};
+            if (token == "class" || token == "struct") return {Kind::TYPE_DEF, NO_BRACKET};
+            if (isOneOf(token, {"return", "throw", "delete"})) return {Kind::STATEMENT, NO_BRACKET};
+            if (token == "new" || token == "sizeof") return {Kind::PREFIX, NO_BRACKET};
+            if (isOneOf(token, {"int", "float", "double", "char", "bool", "void", "string", "auto", "long",
+                                "short", "unsigned", "signed"})) {
+                return {Kind::TYPE, NO_BRACKET};
+            }
+            if (token == "const") return {Kind::QUALIFIER, NO_BRACKET};
+            if (isOneOf(token, {"def", "var", "let", "elif", "static", "constexpr", "case", "template",
+                                "typedef"})) {
+                return {Kind::FOREIGN, NO_BRACKET};
+            }
+            break;
+        case Flavor::JAVASCRIPT:
+            if (token == "if") return {Kind::BRANCH, NO_BRACKET};
+            if (token == "while") return {Kind::LOOP, NO_BRACKET};
+            if (token == "for") return {Kind::FOR, NO_BRACKET};
+            if (token == "function") return {Kind::FUNCTION_DEF, NO_BRACKET};
+            if (token == "class") return {Kind::TYPE_DEF, NO_BRACKET};
+            if (token == "return" || token == "throw") return {Kind::STATEMENT, NO_BRACKET};
+            if (token == "var" || token == "let") return {Kind::BINDING, NO_BRACKET};
+            if (token == "const") return {Kind::CONSTANT, NO_BRACKET};
+            if (isOneOf(token, {"void", "typeof", "new", "delete"})) return {Kind::PREFIX, NO_BRACKET};
+            if (isOneOf(token, {"def", "#include", "using", "namespace", "elif", "switch", "case", "import",
+                                "export"})) {
+                return {Kind::FOREIGN, NO_BRACKET};
+            }
+            break;
+        case Flavor::GENERIC:
+            if (token == "def" || token == "function") return {Kind::FUNCTION_DEF, NO_BRACKET};
+            if (token == "class") return {Kind::TYPE_DEF, NO_BRACKET};
+            if (isOneOf(token, {"if", "for", "while", "return", "var", "let", "const", "using", "namespace",
+                                "#include"})) {
+                return {Kind::STATEMENT, NO_BRACKET};
+            }
+            break;
+    }
+    return {Kind::OPERAND, NO_BRACKET};
+}
+
+// Bracket stacks up to kMaxDepth, numbered depth by depth: the empty
+// stack, then those of depth 1, depth 2 and so on
+constexpr size_t kBracketTypes = NO_BRACKET;
+
+constexpr size_t stackCount() {
+    size_t count = 0;
+    size_t at_depth = 1;
+    for (size_t depth = 0; depth <= TokenGrammar::kMaxDepth; ++depth) {
+        count += at_depth;
+        at_depth *= kBracketTypes;
+    }
+    return count;
+}
+
+// Every parse the numbering can express; only those reachable from the
+// start become automaton states
+constexpr size_t kParseCount = stackCount() * POSITION_COUNT;
+
+struct Stack {
+    size_t depth;
+    size_t digits;  // base kBracketTypes, innermost bracket lowest
+
+    size_t index() const {
+        size_t offset = 0;
+        size_t at_depth = 1;
+        for (size_t d = 0; d < depth; ++d) {
+            offset += at_depth;
+            at_depth *= kBracketTypes;
+        }
+        return offset + digits;
+    }
+
+    Bracket top() const { return depth ? static_cast<Bracket>(digits % kBracketTypes) : NO_BRACKET; }
+    Stack push(Bracket bracket) const { return Stack{depth + 1, digits * kBracketTypes + bracket}; }
+    Stack pop() const { return Stack{depth - 1, digits / kBracketTypes}; }
+    Stack replaceTop(Bracket bracket) const { return pop().push(bracket); }
+
+    // Whether every bracket on the stack is one of those given
+    bool holdsOnly(std::initializer_list<Bracket> brackets) const {
+        size_t rest = digits;
+        for (size_t d = 0; d < depth; ++d, rest /= kBracketTypes) {
+            bool listed = false;
+            for (Bracket bracket : brackets) listed = listed || rest % kBracketTypes == bracket;
+            if (!listed) return false;
+        }
+        return true;
+    }
+};
+
+struct Parse {
+    Position position;
+    Stack stack;
+
+    size_t key() const { return stack.index() * POSITION_COUNT + position; }
+};
+
+bool afterOperand(Position position) {
+    return position == AFTER_TARGET || position == AFTER_OPERAND;
+}
+
+bool startsStatement(Position position) {
+    return position == STATEMENT_START || position == BLOCK_START || position == BRANCH_BODY ||
+           position == AFTER_BRANCH;
+}
+
+bool accepts(const Parse& parse, Flavor flavor) {
+    if (parse.stack.depth != 0) return false;
+    if (parse.position == STATEMENT_START || parse.position == AFTER_BRANCH || parse.position == INCLUDED) {
+        return true;
+    }
+    // C++ statements end with ';' or '}'; Python and JavaScript need no terminator
+    if (flavor == Flavor::CPP) return false;
+    return afterOperand(parse.position) || (flavor == Flavor::JAVASCRIPT && parse.position == NEXT_DECLARATOR);
+}
+
+bool isName(Kind kind) {
+    return kind == Kind::OPERAND;
+}
+
+// ';' after a complete declaration or expression: ends the statement, or
+// a clause of a for header
+bool endClause(const Stack& stack, Parse& to) {
+    switch (stack.top()) {
+        case FOR_INIT:
+            to.stack = stack.replaceTop(FOR_TEST);
+            to.position = OPENED;  // the test may be empty
+            return true;
+        case FOR_TEST:
+            to.stack = stack.replaceTop(CONDITION);
+            to.position = OPENED;  // and so may the update
+            return true;
+        case NO_BRACKET:
+        case BRACE:
+        case BRANCH_BLOCK:
+        case TYPE_BODY:
+        case NAMESPACE_BODY:
+            to.position = STATEMENT_START;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Keyword headers, declarations and definitions, which take only the few
+// tokens listed
+bool stepHeader(const Parse& from, TokenClass token, Flavor flavor, Parse& to) {
+    const bool python = flavor == Flavor::PYTHON;
+    const bool cpp = flavor == Flavor::CPP;
+    const Stack& stack = from.stack;
+    const Kind kind = token.kind;
+    const bool open_paren = kind == Kind::OPEN && token.bracket == PAREN;
+    const bool close_paren = kind == Kind::CLOSE && token.bracket == PAREN;
+    const bool open_brace = kind == Kind::OPEN && token.bracket == BRACE;
+
+    auto move = [&to](Position position) {
+        to.position = position;
+        return true;
+    };
+    auto open = [&](Bracket bracket, Position position) {
+        if (stack.depth == TokenGrammar::kMaxDepth) return false;
+        to.stack = stack.push(bracket);
+        return move(position);
+    };
+
+    switch (from.position) {
+        case BRANCH_KEYWORD:
+            return open_paren && open(BRANCH_CONDITION, EXPECT_OPERAND);
+        case LOOP_KEYWORD:
+            return open_paren && open(CONDITION, EXPECT_OPERAND);
+        case FOR_KEYWORD:
+            return open_paren && open(FOR_INIT, OPENED);
+        case INCLUDE_TARGET:
+            return isName(kind) && move(INCLUDED);
+        case USING_KEYWORD:
+            return kind == Kind::NAMESPACE && move(USING_NAMESPACE);
+        case USING_NAMESPACE:
+            return isName(kind) && move(EXPECT_SEMICOLON);
+        case EXPECT_SEMICOLON:
+            return kind == Kind::SEMICOLON && move(STATEMENT_START);
+        case SPECIFIER:
+            if (kind == Kind::QUALIFIER) return move(SPECIFIERS);
+            return isName(kind) && move(DECLARATOR);
+        case QUALIFIED:
+            return kind == Kind::TYPE && move(SPECIFIERS);
+        case SPECIFIERS:
+            return isName(kind) && move(DECLARATOR);
+        case DECLARATOR:
+            // A function, where definitions are allowed
+            if (open_paren) return stack.holdsOnly({TYPE_BODY, NAMESPACE_BODY}) && move(PARAMS_OPEN);
+            // The element of a range-based for
+            if (kind == Kind::COLON && stack.top() == FOR_INIT) {
+                to.stack = stack.replaceTop(CONDITION);
+                return move(EXPECT_OPERAND);
+            }
+            [[fallthrough]];
+        case NEXT_DECLARATOR:
+            if (kind == Kind::ASSIGN) return move(EXPECT_OPERAND);
+            if (kind == Kind::COMMA) return move(NEXT_NAME);
+            return kind == Kind::SEMICOLON && endClause(stack, to);
+        case NEXT_NAME:
+            return isName(kind) && move(NEXT_DECLARATOR);
+        case CONST_NAME:
+            return isName(kind) && move(CONST_DECLARATOR);
+        case CONST_DECLARATOR:
+            return kind == Kind::ASSIGN && move(EXPECT_OPERAND);
+        case FUNCTION_NAME:
+            return isName(kind) && move(FUNCTION_NAMED);
+        case TYPE_NAME:
+            return isName(kind) && move(TYPE_NAMED);
+        case NAMESPACE_NAME:
+            return isName(kind) && move(NAMESPACE_NAMED);
+        case FUNCTION_NAMED:
+            return open_paren && move(PARAMS_OPEN);
+        case TYPE_NAMED:
+            if (python) {
+                if (open_paren) return move(PARAMS_OPEN);  // base classes
+                return kind == Kind::COLON && move(BLOCK_START);
+            }
+            if (kind == Kind::SEMICOLON && cpp) return move(STATEMENT_START);  // declared only
+            return open_brace && open(flavor == Flavor::GENERIC ? BRACE : TYPE_BODY, STATEMENT_START);
+        case NAMESPACE_NAMED:
+            return open_brace && open(NAMESPACE_BODY, STATEMENT_START);
+        case PARAMS_OPEN:
+            if (close_paren) return move(HEADER_END);
+            [[fallthrough]];
+        case PARAM_NEXT:
+            // C++ parameters start with their type
+            if (!cpp) return isName(kind) && move(PARAM);
+            if (kind == Kind::TYPE) return move(PARAM_TYPE);
+            return kind == Kind::QUALIFIER && move(PARAM_QUALIFIED);
+        case PARAM_QUALIFIED:
+            return kind == Kind::TYPE && move(PARAM_TYPES);
+        case PARAM_TYPE:
+            if (kind == Kind::QUALIFIER) return move(PARAM_TYPES);
+            [[fallthrough]];
+        case PARAM_TYPES:
+            if (isName(kind)) return move(PARAM);
+            [[fallthrough]];  // an unnamed parameter
+        case PARAM:
+            if (kind == Kind::COMMA) return move(PARAM_NEXT);
+            return close_paren && move(HEADER_END);
+        case HEADER_END:
+            if (python) return kind == Kind::COLON && move(BLOCK_START);
+            if (kind == Kind::SEMICOLON && cpp) return move(STATEMENT_START);  // a prototype
+            return open_brace && open(BRACE, STATEMENT_START);
+        default:
+            return false;
+    }
+}
+
+// The parse after token, or false if the token cannot follow
+bool step(const Parse& from, TokenClass token, Flavor flavor, Parse& to) {
+    to.stack = from.stack;
+    if (from.position >= BRANCH_KEYWORD) return stepHeader(from, token, flavor, to);
+    // The directive's line ends with its header
+    if (from.position == INCLUDED) {
+        return token.kind != Kind::SEMICOLON && step(Parse{STATEMENT_START, from.stack}, token, flavor, to);
+    }
+
+    const bool python = flavor == Flavor::PYTHON;
+    const bool cpp = flavor == Flavor::CPP;
+    const Position at = from.position;
+    const Stack& stack = from.stack;
+    const Bracket top = stack.top();
+
+    // C++ and JavaScript class bodies hold members and namespace bodies
+    // declarations, not statements. Declarations need a statement start
+    // of their own, not the lone statement after a loop header or if.
+    const bool members = top == TYPE_BODY;
+    const bool statement = startsStatement(at) && !members && top != NAMESPACE_BODY;
+    const bool declaration = python ? startsStatement(at) : at == STATEMENT_START || at == AFTER_BRANCH;
+    const bool expression_start = at == EXPECT_OPERAND || at == OPENED || statement;
+    // Python statements may follow a complete one on the same line of
+    // tokens, as if a newline separated them
+    const bool python_next_line = python && afterOperand(at) && stack.depth == 0;
+
+    auto move = [&to](Position position) {
+        to.position = position;
+        return true;
+    };
+    auto open = [&](Bracket bracket, Position position) {
+        if (stack.depth == TokenGrammar::kMaxDepth) return false;
+        to.stack = stack.push(bracket);
+        return move(position);
+    };
+
+    switch (token.kind) {
+        case Kind::OPERAND:
+            // A JavaScript method
+            if (members && at == STATEMENT_START && !cpp) return move(FUNCTION_NAMED);
+            if (expression_start) return move(AFTER_TARGET);
+            if (at == EXPECT_RIGHT || at == AFTER_DOT) return move(AFTER_OPERAND);
+            return at == AFTER_TARGET_DOT && move(AFTER_TARGET);
+        case Kind::TYPE:
+        case Kind::QUALIFIER: {
+            // A declaration, or the first clause of a for header
+            if (!declaration && !(at == OPENED && top == FOR_INIT)) return false;
+            return move(token.kind == Kind::TYPE ? SPECIFIER : QUALIFIED);
+        }
+        case Kind::BINDING:
+        case Kind::CONSTANT:
+            if (!(declaration && statement) && !(at == OPENED && top == FOR_INIT)) return false;
+            return move(token.kind == Kind::BINDING ? NEXT_NAME : CONST_NAME);
+        case Kind::SIGN:
+            if (afterOperand(at)) return move(EXPECT_RIGHT);
+            [[fallthrough]];
+        case Kind::PREFIX:
+            return (expression_start || at == EXPECT_RIGHT) && move(EXPECT_RIGHT);
+        case Kind::OPERATOR:
+            return afterOperand(at) && move(EXPECT_RIGHT);
+        case Kind::ASSIGN:
+            // JavaScript and Python assign to names and members only
+            if (at == AFTER_TARGET) return move(EXPECT_OPERAND);
+            return at == AFTER_OPERAND && (cpp || flavor == Flavor::GENERIC) && move(EXPECT_OPERAND);
+        case Kind::DOT:
+            if (at == AFTER_TARGET) return move(AFTER_TARGET_DOT);
+            return at == AFTER_OPERAND && move(AFTER_DOT);
+        case Kind::OPEN:
+            switch (token.bracket) {
+                case PAREN:
+                    // A call, which may be empty, or grouping, which may
+                    // not outside Python
+                    if (afterOperand(at)) return open(PAREN, OPENED);
+                    if (!expression_start && at != EXPECT_RIGHT) return false;
+                    return open(PAREN, python ? OPENED : EXPECT_OPERAND);
+                case SQUARE:
+                    // A subscript, or a list (C++ has none)
+                    if (afterOperand(at)) return open(SQUARE, EXPECT_OPERAND);
+                    return (expression_start || at == EXPECT_RIGHT) && !cpp && open(SQUARE, OPENED);
+                default:
+                    // A Python dict or set, otherwise a block
+                    if (python) return (expression_start || at == EXPECT_RIGHT) && open(BRACE, OPENED);
+                    if (!statement) return false;
+                    return open(at == BRANCH_BODY ? BRANCH_BLOCK : BRACE, STATEMENT_START);
+            }
+        case Kind::CLOSE:
+            if (token.bracket == BRACE && !python) {
+                if (at != STATEMENT_START && at != AFTER_BRANCH) return false;
+                to.stack = stack.pop();
+                switch (top) {
+                    case BRACE:
+                    case NAMESPACE_BODY: return move(STATEMENT_START);
+                    case BRANCH_BLOCK: return move(AFTER_BRANCH);
+                    case TYPE_BODY: return move(cpp ? EXPECT_SEMICOLON : STATEMENT_START);
+                    default: return false;
+                }
+            }
+            if (!afterOperand(at) && at != OPENED) return false;
+            to.stack = stack.pop();
+            switch (top) {
+                case PAREN: return token.bracket == PAREN && move(AFTER_OPERAND);
+                case CONDITION: return token.bracket == PAREN && move(BLOCK_START);
+                case BRANCH_CONDITION: return token.bracket == PAREN && move(BRANCH_BODY);
+                case SQUARE: return token.bracket == SQUARE && move(AFTER_OPERAND);
+                case BRACE: return token.bracket == BRACE && move(AFTER_OPERAND);
+                default: return false;
+            }
+        case Kind::COMMA:
+            if (!afterOperand(at)) return false;
+            switch (top) {
+                case PAREN:
+                case CONDITION:
+                case BRANCH_CONDITION:
+                case FOR_TEST: return move(EXPECT_OPERAND);
+                // C++23 gives a comma in a subscript another meaning
+                case SQUARE: return !cpp && move(EXPECT_OPERAND);
+                case BRACE: return python && move(EXPECT_OPERAND);
+                default: return false;
+            }
+        case Kind::COLON:
+            if (python) {
+                if (at == AFTER_ELSE) return move(BLOCK_START);
+                // Ends a Python block header; otherwise a slice, dict entry
+                // or conditional expression continues
+                if (!afterOperand(at)) return false;
+                return move(stack.depth == 0 ? BLOCK_START : EXPECT_OPERAND);
+            }
+            return flavor == Flavor::GENERIC && afterOperand(at) && move(EXPECT_OPERAND);
+        case Kind::SEMICOLON:
+            if (python) return python_next_line && move(STATEMENT_START);
+            // An empty statement, the end of one, or of a for clause
+            if (startsStatement(at)) return move(STATEMENT_START);
+            if (!afterOperand(at) && !(at == OPENED && (top == FOR_INIT || top == FOR_TEST))) return false;
+            return endClause(stack, to);
+        case Kind::CONDITIONAL:
+            if (statement) return move(EXPECT_OPERAND);
+            return afterOperand(at) && move(EXPECT_RIGHT);
+        case Kind::STATEMENT:
+            return (statement || python_next_line) && move(EXPECT_OPERAND);
+        case Kind::BRANCH:
+            return statement && move(BRANCH_KEYWORD);
+        case Kind::LOOP:
+            return statement && move(LOOP_KEYWORD);
+        case Kind::FOR:
+            return statement && move(FOR_KEYWORD);
+        case Kind::INCLUDE:
+            return declaration && stack.depth == 0 && move(INCLUDE_TARGET);
+        case Kind::USING:
+            return declaration && !members && move(USING_KEYWORD);
+        case Kind::NAMESPACE:
+            return declaration && stack.holdsOnly({NAMESPACE_BODY}) && move(NAMESPACE_NAME);
+        case Kind::FUNCTION_DEF:
+        case Kind::TYPE_DEF: {
+            Position name = token.kind == Kind::FUNCTION_DEF ? FUNCTION_NAME : TYPE_NAME;
+            if (python) return (declaration || python_next_line) && move(name);
+            // C++ classes may also be members
+            return declaration && (statement || (cpp && members)) && move(name);
+        }
+        case Kind::ELSE:
+            if (python) {
+                if (afterOperand(at)) return move(EXPECT_RIGHT);  // conditional expression
+                return startsStatement(at) && move(AFTER_ELSE);
+            }
+            if (flavor == Flavor::GENERIC) return startsStatement(at) && move(STATEMENT_START);
+            return at == AFTER_BRANCH && move(BLOCK_START);
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+TokenGrammar::TokenGrammar(Language language, const std::vector<std::string>& vocabulary)
+    : vocab_size(vocabulary.size()), words((vocabulary.size() + 63) / 64), end_token(-1) {
+    AI_TRACE_SCOPE("TokenGrammar");
+    const Flavor flavor = flavorOf(language);
+
+    std::vector<TokenClass> classes;
+    classes.reserve(vocab_size);
+    for (size_t token = 0; token < vocab_size; ++token) {
+        classes.push_back(classify(vocabulary[token], flavor));
+        if (classes.back().kind == Kind::END && end_token < 0) end_token = static_cast<int>(token);
+    }
+
+    // Number the parses reachable from the start, breadth first, and
+    // record every transition between them
+    std::vector<uint16_t> ids(kParseCount, kInvalid);
+    std::vector<Parse> parses{Parse{STATEMENT_START, Stack{0, 0}}};
+    ids[parses.front().key()] = 0;
+    for (size_t state = 0; state < parses.size(); ++state) {
+        next.resize((state + 1) * vocab_size, kInvalid);
+        for (size_t token = 0; token < vocab_size; ++token) {
+            Parse to{};
+            if (!step(parses[state], classes[token], flavor, to)) continue;
+            uint16_t& target = ids[to.key()];
+            if (target == kInvalid) {
+                if (parses.size() == kInvalid) {
+                    throw std::runtime_error("Grammar for " + languageToString(language) + " has too many states");
+                }
+                target = static_cast<uint16_t>(parses.size());
+                parses.push_back(to);
+            }
+            next[state * vocab_size + token] = target;
+        }
+    }
+    const size_t state_count = parses.size();
+
+    // The reverse edges to search completions on
+    std::vector<std::vector<std::pair<uint16_t, uint32_t>>> incoming(state_count);
+    for (size_t state = 0; state < state_count; ++state) {
+        for (size_t token = 0; token < vocab_size; ++token) {
+            uint16_t target = next[state * vocab_size + token];
+            if (target != kInvalid) {
+                incoming[target].emplace_back(static_cast<uint16_t>(state), static_cast<uint32_t>(token));
+            }
+        }
+    }
+
+    // Breadth first back from the accepting states: each state's first
+    // completion token is on a shortest path, and states never reached
+    // cannot be completed
+    constexpr int32_t kUnreached = std::numeric_limits<int32_t>::min();
+    completion.assign(state_count, kUnreached);
+    std::vector<uint32_t> queue;
+    for (size_t state = 0; state < state_count; ++state) {
+        if (accepts(parses[state], flavor)) {
+            completion[state] = -1;
+            queue.push_back(static_cast<uint32_t>(state));
+        }
+    }
+    for (size_t head = 0; head < queue.size(); ++head) {
+        for (const auto& edge : incoming[queue[head]]) {
+            if (completion[edge.first] != kUnreached) continue;
+            completion[edge.first] = static_cast<int32_t>(edge.second);
+            queue.push_back(edge.first);
+        }
+    }
+    if (completion[start()] == kUnreached) {
+        throw std::runtime_error("Vocabulary cannot form any output for " + languageToString(language));
+    }
+
+    // Valid: leads to a state that can still be completed
+    masks.assign(state_count * words, 0);
+    for (size_t state = 0; state < state_count; ++state) {
+        uint64_t* mask = masks.data() + state * words;
+        for (size_t token = 0; token < vocab_size; ++token) {
+            uint16_t target = next[state * vocab_size + token];
+            if (target != kInvalid && completion[target] != kUnreached) {
+                mask[token >> 6] |= uint64_t{1} << (token & 63);
+            } else {
+                next[state * vocab_size + token] = kInvalid;
+            }
+        }
+    }
+}
+
+int TokenGrammar::constrain(uint32_t state, int proposal) const {
+    const uint64_t* mask = masks.data() + state * words;
+    size_t word = static_cast<size_t>(proposal) >> 6;
+    // Tokens at or after the proposal in its word, then the following
+    // words, then the start of its word again
+    uint64_t candidates = mask[word] & (~uint64_t{0} << (proposal & 63));
+    for (size_t scanned = 0; scanned <= words; ++scanned) {
+        if (candidates) return static_cast<int>((word << 6) + static_cast<size_t>(__builtin_ctzll(candidates)));
+        word = word + 1 == words ? 0 : word + 1;
+        candidates = mask[word];
+    }
+    return -1;
+}
+
+std::vector<int> TokenGrammar::decode(const std::vector<int>& proposals) const {
+    AI_TRACE_SCOPE("constrainedDecode");
+    std::vector<int> tokens;
+    tokens.reserve(proposals.size());
+    uint32_t state = start();
+    for (int proposal : proposals) {
+        if (proposal < 0 || static_cast<size_t>(proposal) >= vocab_size) continue;
+        // Ends the output only where it may end, and is never substituted
+        if (proposal == end_token && accepting(state)) break;
+        int token = constrain(state, proposal);
+        if (token < 0) break;
+        tokens.push_back(token);
+        state = advance(state, token);
+    }
+
+    while (!accepting(state)) {
+        int token = completion[state];
+        tokens.push_back(token);
+        state = advance(state, token);
+    }
+    return tokens;
+}
+
+} // namespace AIEngine
@@ -0,0 +1,337 @@
+#include "ai_engine/http_server.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "ai_engine/json.h"
+#include "ai_engine/metrics.h"
+#include "ai_engine/router.h"
+#include "ai_engine/trace.h"
+
+namespace AIEngine {
+
+int HttpServer::openTcpSocket(const std::string& host, int port) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    addrinfo* addresses = nullptr;
+    std::string service = std::to_string(port);
+    int rc = ::getaddrinfo(host.empty() ? nullptr : host.c_str(), service.c_str(), &hints, &addresses);
+    if (rc != 0) {
+        throw std::runtime_error("Cannot resolve " + host + ": " + gai_strerror(rc));
+    }
+
+    std::string failure = "no usable address";
+    for (addrinfo* address = addresses; address; address = address->ai_next) {
+        int fd = ::socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                          address->ai_protocol);
+        if (fd < 0) continue;
+
+        int one = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (::bind(fd, address->ai_addr, address->ai_addrlen) == 0 && ::listen(fd, SOMAXCONN) == 0) {
+            ::freeaddrinfo(addresses);
+            return fd;
+        }
+        failure = std::strerror(errno);
+        ::close(fd);
+    }
+
+    ::freeaddrinfo(addresses);
+    throw std::runtime_error("Cannot listen on " + host + ":" + service + ": " + failure);
+}
+
+void HttpServer::onAccept(int fd) {
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+bool HttpServer::onInput(uint64_t connection_id, Connection& conn) {
+    size_t offset = 0;
+
+    while (!(conn.protocol_state & kStateClosing)) {
+        size_t header_end = conn.input.find("\r\n\r\n", offset);
+        if (header_end == std::string::npos) {
+            if (conn.input.size() - offset > kMaxHeaderSize) {
+                replyError(connection_id, conn, 431, "Request Header Fields Too Large", false);
+            }
+            break;
+        }
+
+        Request request;
+        std::string_view head(conn.input.data() + offset, header_end - offset);
+        if (!parseHead(head, request)) {
+            replyError(connection_id, conn, 400, "Bad Request", false);
+            break;
+        }
+        if (request.chunked) {
+            replyError(connection_id, conn, 501, "Not Implemented", false);
+            break;
+        }
+        if (request.content_length > kMaxBodySize) {
+            replyError(connection_id, conn, 413, "Payload Too Large", false);
+            break;
+        }
+
+        size_t body_start = header_end + 4;
+        if (conn.input.size() - body_start < request.content_length) {
+            if (request.expect_continue && !(conn.protocol_state & kStateContinueSent) &&
+                !hasPendingReplies(conn)) {
+                sendInterim(conn, "HTTP/1.1 100 Continue\r\n\r\n");
+                conn.protocol_state |= kStateContinueSent;
+            }
+            break;
+        }
+
+        std::string_view body(conn.input.data() + body_start, request.content_length);
+        offset = body_start + request.content_length;
+        conn.protocol_state &= ~kStateContinueSent;
+
+        route(connection_id, conn, request, body);
+        if (!request.keep_alive) {
+            conn.protocol_state |= kStateClosing;
+            closeWhenDone(connection_id, conn);
+        }
+    }
+
+    if (conn.protocol_state & kStateClosing) {
+        conn.input.clear();
+    } else {
+        conn.input.erase(0, offset);
+    }
+    return true;
+}
+
+bool HttpServer::equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string_view HttpServer::trim(std::string_view value) {
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+    return value;
+}
+
+bool HttpServer::parseHead(std::string_view head, Request& request) {
+    size_t line_end = head.find("\r\n");
+    std::string_view line = head.substr(0, line_end);
+
+    size_t first_space = line.find(' ');
+    size_t second_space = line.find(' ', first_space + 1);
+    if (first_space == std::string_view::npos || second_space == std::string_view::npos) return false;
+
+    request.method = line.substr(0, first_space);
+    request.path = line.substr(first_space + 1, second_space - first_space - 1);
+    std::string_view version = line.substr(second_space + 1);
+    if (version == "HTTP/1.1") {
+        request.minor_version = 1;
+    } else if (version == "HTTP/1.0") {
+        request.minor_version = 0;
+        request.keep_alive = false;
+    } else {
+        return false;
+    }
+
+    size_t query = request.path.find('?');
+    if (query != std::string_view::npos) request.path = request.path.substr(0, query);
+
+    while (line_end != std::string_view::npos) {
+        size_t start = line_end + 2;
+        line_end = head.find("\r\n", start);
+        std::string_view header = head.substr(start, line_end == std::string_view::npos
+                                                  ? std::string_view::npos : line_end - start);
+        size_t colon = header.find(':');
+        if (colon == std::string_view::npos) return false;
+
+        std::string_view name = header.substr(0, colon);
+        std::string_view value = trim(header.substr(colon + 1));
+
+        if (equalsIgnoreCase(name, "content-length")) {
+            size_t length = 0;
+            if (value.empty()) return false;
+            for (char c : value) {
+                if (c < '0' || c > '9' || length > kMaxBodySize) return false;
+                length = length * 10 + static_cast<size_t>(c - '0');
+            }
+            request.content_length = length;
+        } else if (equalsIgnoreCase(name, "connection")) {
+            if (equalsIgnoreCase(value, "close")) request.keep_alive = false;
+            if (equalsIgnoreCase(value, "keep-alive")) request.keep_alive = true;
+        } else if (equalsIgnoreCase(name, "transfer-encoding")) {
+            request.chunked = !equalsIgnoreCase(value, "identity");
+        } else if (equalsIgnoreCase(name, "expect")) {
+            request.expect_continue = equalsIgnoreCase(value, "100-continue");
+        }
+    }
+    return true;
+}
+
+void HttpServer::route(uint64_t connection_id, Connection& conn, const Request& request, std::string_view body) {
+    bool keep_alive = request.keep_alive;
+
+    if (request.method == "OPTIONS") {
+        reply(conn, responseHead(204, "No Content", "text/plain", 0, keep_alive, request.minor_version));
+        return;
+    }
+
+    if (request.path == "/health") {
+        if (request.method != "GET") return replyError(connection_id, conn, 405, "Method Not Allowed", keep_alive);
+        reply(conn, jsonResponse("{\"status\":\"healthy\",\"ai_engine\":\"ready\"}", keep_alive,
+                                 request.minor_version));
+        return;
+    }
+
+    if (request.path == "/metrics") {
+        if (request.method != "GET") return replyError(connection_id, conn, 405, "Method Not Allowed", keep_alive);
+        // Rendered on the loop thread from per-thread shards: workers are never blocked
+        std::string text = Metrics::formatPrometheus(AIEngineServer::metrics()) + Router::shared().formatPrometheus();
+        reply(conn, responseHead(200, "OK", "text/plain; version=0.0.4", text.size(), keep_alive,
+                                 request.minor_version) + text);
+        return;
+    }
+
+    if (request.path == "/trace") {
+        if (request.method != "GET") return replyError(connection_id, conn, 405, "Method Not Allowed", keep_alive);
+        // Spans recorded so far (empty unless tracing is enabled), as Chrome trace JSON
+        reply(conn, jsonResponse(Trace::exportChrome(), keep_alive, request.minor_version));
+        return;
+    }
+
+    if (request.path == "/") {
+        reply(conn, jsonResponse(
+            "{\"message\":\"AI Engine HTTP Server (C++)\",\"status\":\"running\","
+            "\"endpoints\":{\"generate\":\"/api/generate\",\"analyze\":\"/api/analyze\","
+            "\"health\":\"/health\",\"metrics\":\"/metrics\"}}", keep_alive, request.minor_version));
+        return;
+    }
+
+    RequestType type;
+    if (request.path == "/api/generate") {
+        type = RequestType::GENERATE_CODE;
+    } else if (request.path == "/api/analyze") {
+        type = RequestType::ANALYZE_CODE;
+    } else {
+        return replyError(connection_id, conn, 404, "Not Found", keep_alive);
+    }
+    if (request.method != "POST") {
+        return replyError(connection_id, conn, 405, "Method Not Allowed", keep_alive);
+    }
+
+    CodeRequest code_request;
+    bool stream = false;
+    std::string error;
+    if (!requestFromJson(body, type, code_request, stream, error)) {
+        std::string json = errorToJson(error);
+        reply(conn, responseHead(400, "Bad Request", "application/json", json.size(), keep_alive,
+                                 request.minor_version) + json);
+        return;
+    }
+
+    code_request.received_at = std::chrono::steady_clock::now();
+
+    // HTTP/1.0 has no chunked encoding
+    stream = stream && request.minor_version == 1;
+    int minor_version = request.minor_version;
+
+    submit(connection_id, conn, [this, code_request = std::move(code_request), stream,
+                                 keep_alive, minor_version]() {
+        CodeResponse response = engine.processRequest(code_request);
+        return stream ? streamedResponse(response, keep_alive)
+                      : jsonResponse(responseToJson(response), keep_alive, minor_version);
+    });
+}
+
+std::string HttpServer::responseHead(int status, const char* reason, const char* content_type,
+                                     size_t content_length, bool keep_alive, int minor_version) {
+    std::string head = "HTTP/1.1 " + std::to_string(status) + " " + reason + "\r\n";
+    head += "Content-Type: ";
+    head += content_type;
+    head += "\r\nContent-Length: " + std::to_string(content_length) + "\r\n";
+    head += "Access-Control-Allow-Origin: *\r\n";
+    if (status == 204) {
+        head += "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n";
+        head += "Access-Control-Allow-Headers: Content-Type\r\n";
+    }
+    if (!keep_alive) {
+        head += "Connection: close\r\n";
+    } else if (minor_version == 0) {
+        head += "Connection: keep-alive\r\n";
+    }
+    head += "\r\n";
+    return head;
+}
+
+std::string HttpServer::jsonResponse(const std::string& json, bool keep_alive, int minor_version) {
+    return responseHead(200, "OK", "application/json", json.size(), keep_alive, minor_version) + json;
+}
+
+void HttpServer::replyError(uint64_t connection_id, Connection& conn, int status, const char* reason,
+                            bool keep_alive) {
+    std::string json = errorToJson(reason);
+    reply(conn, responseHead(status, reason, "application/json", json.size(), keep_alive, 1) + json);
+
+    if (!keep_alive) {
+        conn.protocol_state |= kStateClosing;
+        closeWhenDone(connection_id, conn);
+    }
+}
+
+void HttpServer::appendChunk(std::string& out, const std::string& data) {
+    char size[20];
+    std::snprintf(size, sizeof(size), "%zx\r\n", data.size());
+    out += size;
+    out += data;
+    out += "\r\n";
+}
+
+std::string HttpServer::streamedResponse(const CodeResponse& response, bool keep_alive) {
+    std::string out = "HTTP/1.1 200 OK\r\nContent-Type: application/x-ndjson\r\n"
+                      "Transfer-Encoding: chunked\r\nAccess-Control-Allow-Origin: *\r\n";
+    if (!keep_alive) out += "Connection: close\r\n";
+    out += "\r\n";
+
+    size_t pos = 0;
+    while (pos < response.code.size()) {
+        size_t length = std::min(kStreamChunkSize, response.code.size() - pos);
+        size_t newline = response.code.rfind('\n', pos + length - 1);
+        if (pos + length < response.code.size() && newline != std::string::npos && newline >= pos) {
+            length = newline - pos + 1;
+        }
+
+        std::string event = "{\"type\":\"code\",\"text\":";
+        Json::appendString(event, std::string_view(response.code).substr(pos, length));
+        event += "}\n";
+        appendChunk(out, event);
+        pos += length;
+    }
+
+    CodeResponse summary = response;
+    summary.code.clear();
+    std::string done = responseToJson(summary);
+    done.insert(1, "\"type\":\"done\",");
+    done += "\n";
+    appendChunk(out, done);
+    out += "0\r\n\r\n";
+    return out;
+}
+
+} // namespace AIEngine
@@ -0,0 +1,914 @@
+#include "ai_engine/io_backend.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// io_uring backend for the socket transports (raw syscalls, no liburing)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+namespace AIEngine {
+
+namespace {
+
+class EpollBackend : public IoBackend {
+private:
+    // Out of the range of connection keys
+    static constexpr uint64_t kListenKey = UINT64_MAX;
+    static constexpr uint64_t kWakeKey = UINT64_MAX - 1;
+
+    struct Socket {
+        int fd = -1;
+        bool receiving = true;
+        bool paused = false;
+        bool writable_armed = false;
+        const char* send_data = nullptr;
+        size_t send_size = 0;
+        size_t sent = 0;
+    };
+
+    int listen_fd;
+    int epoll_fd;
+    int wake_fd;
+    std::atomic<bool> stopping;
+    std::unordered_map<uint64_t, Socket> sockets;
+    Handler* handler;
+
+public:
+    explicit EpollBackend(int listening_fd)
+        : listen_fd(listening_fd), epoll_fd(-1), wake_fd(-1), stopping(false), handler(nullptr) {
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epoll_fd < 0 || wake_fd < 0) {
+            throw std::runtime_error(std::string("epoll setup failed: ") + std::strerror(errno));
+        }
+        watch(listen_fd, kListenKey, EPOLLIN);
+        watch(wake_fd, kWakeKey, EPOLLIN);
+    }
+
+    ~EpollBackend() override {
+        for (auto& entry : sockets) {
+            ::close(entry.second.fd);
+        }
+        ::close(wake_fd);
+        ::close(epoll_fd);
+    }
+
+    const char* name() const override { return "epoll"; }
+
+    void addConnection(uint64_t key, int fd) override {
+        sockets[key].fd = fd;
+        watch(fd, key, EPOLLIN | EPOLLRDHUP);
+    }
+
+    void stopReceiving(uint64_t key) override {
+        auto it = sockets.find(key);
+        if (it == sockets.end() || !it->second.receiving) return;
+        it->second.receiving = false;
+        updateInterest(key, it->second);
+    }
+
+    void pauseReceiving(uint64_t key) override {
+        setPaused(key, true);
+    }
+
+    void resumeReceiving(uint64_t key) override {
+        setPaused(key, false);
+    }
+
+    void send(uint64_t key, const char* data, size_t size) override {
+        auto it = sockets.find(key);
+        if (it == sockets.end()) return;
+        it->second.send_data = data;
+        it->second.send_size = size;
+        it->second.sent = 0;
+        continueSend(key);
+    }
+
+    void closeConnection(uint64_t key) override {
+        auto it = sockets.find(key);
+        if (it == sockets.end()) return;
+        ::close(it->second.fd);  // also removes it from the epoll set
+        sockets.erase(it);
+    }
+
+    void run(Handler& event_handler) override {
+        handler = &event_handler;
+        epoll_event events[64];
+
+        while (!stopping.load()) {
+            int count = epoll_wait(epoll_fd, events, 64, -1);
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(std::string("epoll_wait failed: ") + std::strerror(errno));
+            }
+
+            for (int i = 0; i < count; ++i) {
+                uint64_t key = events[i].data.u64;
+                if (key == kListenKey) {
+                    acceptConnections();
+                } else if (key == kWakeKey) {
+                    uint64_t counter;
+                    while (::read(wake_fd, &counter, sizeof(counter)) > 0) {}
+                    handler->onWake();
+                } else {
+                    handleSocketEvent(key, events[i].events);
+                }
+            }
+        }
+    }
+
+    void wake() override {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wake_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    void stop() override {
+        stopping.store(true);
+        wake();
+    }
+
+private:
+    void watch(int fd, uint64_t key, uint32_t events) {
+        epoll_event event{};
+        event.events = events;
+        event.data.u64 = key;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            throw std::runtime_error(std::string("epoll_ctl failed: ") + std::strerror(errno));
+        }
+    }
+
+    void setPaused(uint64_t key, bool paused) {
+        auto it = sockets.find(key);
+        if (it == sockets.end() || it->second.paused == paused) return;
+        it->second.paused = paused;
+        updateInterest(key, it->second);
+    }
+
+    // Input interest is dropped once receiving stops or pauses, or the
+    // level-triggered EPOLLRDHUP of a half-closed peer would fire on every
+    // iteration
+    void updateInterest(uint64_t key, Socket& socket) {
+        epoll_event event{};
+        event.events = 0;
+        if (socket.receiving && !socket.paused) event.events |= EPOLLIN | EPOLLRDHUP;
+        if (socket.writable_armed) event.events |= EPOLLOUT;
+        event.data.u64 = key;
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, socket.fd, &event);
+    }
+
+    void acceptConnections() {
+        while (true) {
+            int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR) continue;
+                return;  // EAGAIN, or a transient error we retry on the next event
+            }
+            handler->onAccepted(fd);
+        }
+    }
+
+    void handleSocketEvent(uint64_t key, uint32_t events) {
+        auto it = sockets.find(key);
+        if (it == sockets.end()) return;
+
+        if (events & EPOLLOUT) {
+            continueSend(key);
+        }
+
+        it = sockets.find(key);  // handlers may have closed the connection
+        if (it == sockets.end()) return;
+
+        bool reading = it->second.receiving && !it->second.paused;
+        if (reading && (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+            receive(key);
+        } else if (!reading && (events & (EPOLLHUP | EPOLLERR))) {
+            handler->onFailed(key);  // fully closed: nothing more can be written
+        }
+    }
+
+    void receive(uint64_t key) {
+        char buffer[64 * 1024];
+
+        while (true) {
+            auto it = sockets.find(key);
+            if (it == sockets.end() || !it->second.receiving || it->second.paused) return;
+
+            ssize_t received = ::recv(it->second.fd, buffer, sizeof(buffer), 0);
+            if (received > 0) {
+                handler->onReceived(key, buffer, static_cast<size_t>(received));
+                continue;
+            }
+            if (received < 0 && errno == EINTR) continue;
+            if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+
+            if (received == 0) {
+                handler->onReceived(key, nullptr, 0);
+            } else {
+                handler->onFailed(key);
+            }
+            return;
+        }
+    }
+
+    void continueSend(uint64_t key) {
+        auto it = sockets.find(key);
+        if (it == sockets.end() || it->second.send_data == nullptr) return;
+        Socket& socket = it->second;
+
+        while (socket.sent < socket.send_size) {
+            ssize_t sent = ::send(socket.fd, socket.send_data + socket.sent,
+                                  socket.send_size - socket.sent, MSG_NOSIGNAL);
+            if (sent > 0) {
+                socket.sent += static_cast<size_t>(sent);
+                continue;
+            }
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (!socket.writable_armed) {
+                    socket.writable_armed = true;
+                    updateInterest(key, socket);
+                }
+                return;
+            }
+            handler->onFailed(key);
+            return;
+        }
+
+        socket.send_data = nullptr;
+        if (socket.writable_armed) {
+            socket.writable_armed = false;
+            updateInterest(key, socket);
+        }
+        handler->onSent(key);
+    }
+};
+
+// Thin wrapper over the raw io_uring syscalls (no liburing dependency):
+// maps the rings, hands out SQEs and publishes them in batches
+class Uring {
+private:
+    int ring_fd;
+    unsigned entries;
+    void* sq_ptr;
+    size_t sq_size;
+    void* cq_ptr;
+    size_t cq_size;
+    io_uring_sqe* sqes;
+    size_t sqes_size;
+
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    io_uring_cqe* cqes;
+
+    unsigned local_tail;   // SQEs handed out, not yet published to the kernel
+    unsigned published;    // SQEs published, not yet submitted
+
+public:
+    // Throws if the kernel or the sandbox does not allow io_uring
+    explicit Uring(unsigned queue_entries)
+        : ring_fd(-1), entries(0), sq_ptr(MAP_FAILED), sq_size(0), cq_ptr(MAP_FAILED), cq_size(0),
+          sqes(nullptr), sqes_size(0), local_tail(0), published(0) {
+        io_uring_params params{};
+        ring_fd = static_cast<int>(::syscall(__NR_io_uring_setup, queue_entries, &params));
+        if (ring_fd < 0) {
+            throw std::runtime_error(std::string("io_uring_setup failed: ") + std::strerror(errno));
+        }
+        entries = params.sq_entries;
+
+        sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) sq_size = cq_size = std::max(sq_size, cq_size);
+
+        sq_ptr = ::mmap(nullptr, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring_fd, IORING_OFF_SQ_RING);
+        cq_ptr = single_mmap ? sq_ptr
+                             : ::mmap(nullptr, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                      ring_fd, IORING_OFF_CQ_RING);
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes_ptr = ::mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                ring_fd, IORING_OFF_SQES);
+        if (sq_ptr == MAP_FAILED || cq_ptr == MAP_FAILED || sqes_ptr == MAP_FAILED) {
+            if (sqes_ptr != MAP_FAILED) ::munmap(sqes_ptr, sqes_size);
+            release();
+            throw std::runtime_error("io_uring ring mmap failed");
+        }
+        sqes = static_cast<io_uring_sqe*>(sqes_ptr);
+
+        char* sq = static_cast<char*>(sq_ptr);
+        sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+        char* cq = static_cast<char*>(cq_ptr);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        local_tail = *sq_tail;
+    }
+
+    ~Uring() {
+        if (sqes) ::munmap(sqes, sqes_size);
+        release();
+    }
+
+    Uring(const Uring&) = delete;
+    Uring& operator=(const Uring&) = delete;
+
+    int fd() const { return ring_fd; }
+
+    bool supports(std::initializer_list<int> opcodes) {
+        size_t size = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+        std::vector<char> storage(size, 0);
+        auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+        if (::syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, 256) < 0) {
+            return false;
+        }
+        for (int opcode : opcodes) {
+            if (opcode > probe->last_op || !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool registerBuffers(const iovec* buffers, unsigned count) {
+        return ::syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS, buffers, count) == 0;
+    }
+
+    // A zeroed SQE; flushes queued entries to the kernel if the ring is full
+    io_uring_sqe* next() {
+        if (local_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) >= entries) {
+            submit(0);
+        }
+        unsigned index = local_tail & *sq_mask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sq_array[index] = index;
+        local_tail++;
+        return sqe;
+    }
+
+    // Publishes queued SQEs and submits them with one syscall, optionally
+    // waiting for completions in the same call
+    void submit(unsigned wait_for) {
+        __atomic_store_n(sq_tail, local_tail, __ATOMIC_RELEASE);
+        unsigned to_submit = local_tail - published;
+
+        while (true) {
+            long rc = ::syscall(__NR_io_uring_enter, ring_fd, to_submit, wait_for,
+                                wait_for ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+            if (rc >= 0) {
+                published += static_cast<unsigned>(rc);
+                return;
+            }
+            if (errno == EINTR) {
+                if (to_submit == 0) return;
+                continue;
+            }
+            if (errno == EAGAIN || errno == EBUSY) return;  // retried on the next call
+            throw std::runtime_error(std::string("io_uring_enter failed: ") + std::strerror(errno));
+        }
+    }
+
+    // SQEs the kernel has taken since the ring was set up
+    unsigned submitted() const { return published; }
+
+    // Blocks for a completion without submitting; never throws, and yields
+    // instead if the kernel refuses to wait
+    void waitForCompletion() {
+        if (::syscall(__NR_io_uring_enter, ring_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 &&
+            errno != EINTR) {
+            sched_yield();
+        }
+    }
+
+    template<typename Visitor>
+    unsigned reap(Visitor&& visit) {
+        unsigned head = *cq_head;
+        unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        unsigned count = 0;
+
+        while (head != tail) {
+            io_uring_cqe cqe = cqes[head & *cq_mask];
+            head++;
+            count++;
+            // Hand the slot back before visiting, which may queue more work
+            __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+            visit(cqe);
+            tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        }
+        return count;
+    }
+
+private:
+    void release() {
+        if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) ::munmap(cq_ptr, cq_size);
+        if (sq_ptr != MAP_FAILED) ::munmap(sq_ptr, sq_size);
+        if (ring_fd >= 0) ::close(ring_fd);
+    }
+};
+
+class UringBackend : public IoBackend {
+private:
+    enum Operation : uint64_t { ACCEPT = 0, WAKE = 1, RECEIVE = 2, SEND = 3, ACCEPT_RETRY = 4 };
+    static constexpr unsigned kOperationBits = 3;
+
+    static constexpr unsigned kQueueEntries = 1024;
+    // Pause after a failed accept, doubled while accepts keep failing (out
+    // of descriptors, say) so that they are not retried in a tight loop
+    static constexpr long long kAcceptBackoffMinNs = 1000000;
+    static constexpr long long kAcceptBackoffMaxNs = 1000000000;
+    static constexpr size_t kBufferCount = 128;
+    static constexpr size_t kBufferSize = 32 * 1024;
+
+    struct Socket {
+        int fd = -1;
+        int buffer_index = -1;              // registered buffer, or -1 for heap
+        std::unique_ptr<char[]> heap_buffer;
+        bool receiving = true;
+        bool paused = false;
+        bool receive_pending = false;
+        bool send_pending = false;
+        bool closing = false;
+        const char* send_data = nullptr;
+        size_t send_size = 0;
+        size_t sent = 0;
+    };
+
+    Uring ring;
+    int listen_fd;
+    int wake_fd;
+    uint64_t wake_value;
+    __kernel_timespec accept_backoff;
+    std::atomic<bool> stopping;
+    bool wake_pending;
+    std::unordered_map<uint64_t, Socket> sockets;
+    std::unique_ptr<char[]> buffer_pool;
+    std::vector<int> free_buffers;
+    Handler* handler;
+
+public:
+    // Throws when io_uring or an operation we need is unavailable
+    static std::unique_ptr<IoBackend> create(int listening_fd) {
+        return std::unique_ptr<IoBackend>(new UringBackend(listening_fd));
+    }
+
+    // Reads still in flight write into the receive buffers and wake_value,
+    // so they are completed and reaped before anything is freed
+    ~UringBackend() override {
+        stopping.store(true);
+        for (auto& entry : sockets) {
+            ::shutdown(entry.second.fd, SHUT_RDWR);
+        }
+        if (wake_pending) wake();
+        try {
+            while (!drained()) {
+                ring.submit(1);
+                ring.reap([this](const io_uring_cqe& cqe) { retire(cqe); });
+            }
+        } catch (const std::exception&) {
+            // Leaked rather than freed under the kernel
+            buffer_pool.release();
+            for (auto& entry : sockets) {
+                entry.second.heap_buffer.release();
+            }
+        }
+        for (auto& entry : sockets) {
+            ::close(entry.second.fd);
+        }
+        ::close(wake_fd);
+    }
+
+    const char* name() const override {
+        return buffer_pool ? "io_uring (registered buffers)" : "io_uring";
+    }
+
+    void addConnection(uint64_t key, int fd) override {
+        Socket& socket = sockets[key];
+        socket.fd = fd;
+        if (!free_buffers.empty()) {
+            socket.buffer_index = free_buffers.back();
+            free_buffers.pop_back();
+        } else {
+            socket.heap_buffer.reset(new char[kBufferSize]);
+        }
+        queueReceive(key, socket);
+    }
+
+    void stopReceiving(uint64_t key) override {
+        auto it = sockets.find(key);
+        if (it != sockets.end()) it->second.receiving = false;
+    }
+
+    void pauseReceiving(uint64_t key) override {
+        auto it = sockets.find(key);
+        if (it != sockets.end()) it->second.paused = true;
+    }
+
+    // The receive is re-armed unless one is still pending, which re-arms
+    // itself on completion
+    void resumeReceiving(uint64_t key) override {
+        auto it = sockets.find(key);
+        if (it == sockets.end() || !it->second.paused) return;
+        Socket& socket = it->second;
+        socket.paused = false;
+        if (socket.receiving && !socket.closing && !socket.receive_pending) queueReceive(key, socket);
+    }
+
+    void send(uint64_t key, const char* data, size_t size) override {
+        auto it = sockets.find(key);
+        if (it == sockets.end() || it->second.closing) return;
+        it->second.send_data = data;
+        it->second.send_size = size;
+        it->second.sent = 0;
+        queueSend(key, it->second);
+    }
+
+    // Pending operations still reference the socket's buffer, so the fd
+    // is shut down to complete them and released once they have
+    void closeConnection(uint64_t key) override {
+        auto it = sockets.find(key);
+        if (it == sockets.end() || it->second.closing) return;
+        it->second.closing = true;
+        it->second.receiving = false;
+        ::shutdown(it->second.fd, SHUT_RDWR);
+        releaseIfIdle(key);
+    }
+
+    void run(Handler& event_handler) override {
+        handler = &event_handler;
+        queueAccept();
+        queueWakeRead();
+
+        while (!stopping.load()) {
+            ring.submit(1);
+            ring.reap([this](const io_uring_cqe& cqe) { complete(cqe); });
+        }
+    }
+
+    void wake() override {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wake_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    void stop() override {
+        stopping.store(true);
+        wake();
+    }
+
+private:
+    explicit UringBackend(int listening_fd)
+        : ring(kQueueEntries), listen_fd(listening_fd), wake_fd(-1), wake_value(0),
+          accept_backoff{0, 0}, stopping(false), wake_pending(false), handler(nullptr) {
+        if (!ring.supports({IORING_OP_ACCEPT, IORING_OP_READ, IORING_OP_READ_FIXED,
+                            IORING_OP_RECV, IORING_OP_SEND, IORING_OP_TIMEOUT})) {
+            throw std::runtime_error("kernel lacks required io_uring operations");
+        }
+
+        // Operations on blocking descriptors park in the kernel instead of
+        // completing with -EAGAIN
+        int flags = ::fcntl(listen_fd, F_GETFL);
+        ::fcntl(listen_fd, F_SETFL, flags & ~O_NONBLOCK);
+
+        wake_fd = eventfd(0, EFD_CLOEXEC);
+        if (wake_fd < 0) {
+            throw std::runtime_error(std::string("eventfd failed: ") + std::strerror(errno));
+        }
+
+        // Registered receive buffers skip per-operation page pinning; if
+        // RLIMIT_MEMLOCK is too low, sockets fall back to heap buffers
+        buffer_pool.reset(new char[kBufferCount * kBufferSize]);
+        std::vector<iovec> buffers(kBufferCount);
+        for (size_t i = 0; i < kBufferCount; ++i) {
+            buffers[i].iov_base = buffer_pool.get() + i * kBufferSize;
+            buffers[i].iov_len = kBufferSize;
+        }
+        if (ring.registerBuffers(buffers.data(), kBufferCount)) {
+            for (size_t i = kBufferCount; i > 0; --i) {
+                free_buffers.push_back(static_cast<int>(i - 1));
+            }
+        } else {
+            buffer_pool.reset();
+        }
+    }
+
+    static uint64_t tag(uint64_t key, Operation operation) { return (key << kOperationBits) | operation; }
+
+    char* receiveBuffer(Socket& socket) {
+        return socket.buffer_index >= 0 ? buffer_pool.get() + socket.buffer_index * kBufferSize
+                                        : socket.heap_buffer.get();
+    }
+
+    void queueAccept() {
+        io_uring_sqe* sqe = ring.next();
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = listen_fd;
+        sqe->accept_flags = SOCK_CLOEXEC;
+        sqe->user_data = tag(0, ACCEPT);
+    }
+
+    // Re-arms the accept once accept_backoff has passed
+    void queueAcceptRetry() {
+        long long delay = accept_backoff.tv_sec * 1000000000LL + accept_backoff.tv_nsec;
+        delay = std::min(std::max(delay * 2, kAcceptBackoffMinNs), kAcceptBackoffMaxNs);
+        accept_backoff.tv_sec = delay / 1000000000LL;
+        accept_backoff.tv_nsec = delay % 1000000000LL;
+
+        io_uring_sqe* sqe = ring.next();
+        sqe->opcode = IORING_OP_TIMEOUT;
+        sqe->addr = reinterpret_cast<uint64_t>(&accept_backoff);
+        sqe->len = 1;
+        sqe->user_data = tag(0, ACCEPT_RETRY);
+    }
+
+    void queueWakeRead() {
+        io_uring_sqe* sqe = ring.next();
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = wake_fd;
+        sqe->addr = reinterpret_cast<uint64_t>(&wake_value);
+        sqe->len = sizeof(wake_value);
+        sqe->user_data = tag(0, WAKE);
+        wake_pending = true;
+    }
+
+    void queueReceive(uint64_t key, Socket& socket) {
+        io_uring_sqe* sqe = ring.next();
+        sqe->opcode = socket.buffer_index >= 0 ? IORING_OP_READ_FIXED : IORING_OP_RECV;
+        sqe->fd = socket.fd;
+        sqe->addr = reinterpret_cast<uint64_t>(receiveBuffer(socket));
+        sqe->len = kBufferSize;
+        if (socket.buffer_index >= 0) sqe->buf_index = static_cast<uint16_t>(socket.buffer_index);
+        sqe->user_data = tag(key, RECEIVE);
+        socket.receive_pending = true;
+    }
+
+    void queueSend(uint64_t key, Socket& socket) {
+        io_uring_sqe* sqe = ring.next();
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = socket.fd;
+        sqe->addr = reinterpret_cast<uint64_t>(socket.send_data + socket.sent);
+        sqe->len = static_cast<uint32_t>(std::min<size_t>(socket.send_size - socket.sent, UINT32_MAX));
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->user_data = tag(key, SEND);
+        socket.send_pending = true;
+    }
+
+    void complete(const io_uring_cqe& cqe) {
+        uint64_t key = cqe.user_data >> kOperationBits;
+        auto operation = static_cast<Operation>(cqe.user_data & ((1u << kOperationBits) - 1));
+
+        switch (operation) {
+            case ACCEPT:
+                if (stopping.load()) return;
+                if (cqe.res >= 0) {
+                    handler->onAccepted(cqe.res);
+                    accept_backoff = {0, 0};
+                } else if (cqe.res != -EINTR && cqe.res != -EAGAIN && cqe.res != -ECONNABORTED) {
+                    queueAcceptRetry();
+                    return;
+                }
+                queueAccept();
+                return;
+
+            case ACCEPT_RETRY:
+                if (!stopping.load()) queueAccept();
+                return;
+
+            case WAKE:
+                wake_pending = false;
+                handler->onWake();
+                if (!stopping.load()) queueWakeRead();
+                return;
+
+            case RECEIVE:
+                completeReceive(key, cqe.res);
+                return;
+
+            case SEND:
+                completeSend(key, cqe.res);
+                return;
+        }
+    }
+
+    void completeReceive(uint64_t key, int result) {
+        auto it = sockets.find(key);
+        if (it == sockets.end()) return;
+        Socket& socket = it->second;
+        socket.receive_pending = false;
+
+        if (socket.closing) {
+            releaseIfIdle(key);
+        } else if (!socket.receiving) {
+            // Input after stopReceiving() is dropped, as epoll would not read it
+        } else if (result > 0) {
+            handler->onReceived(key, receiveBuffer(socket), static_cast<size_t>(result));
+            it = sockets.find(key);
+            if (it != sockets.end() && it->second.receiving && !it->second.paused && !it->second.closing) {
+                queueReceive(key, it->second);
+            }
+        } else if (result == 0) {
+            socket.receiving = false;
+            handler->onReceived(key, nullptr, 0);
+        } else if (result == -EINTR || result == -EAGAIN) {
+            if (!socket.paused) queueReceive(key, socket);
+        } else {
+            handler->onFailed(key);
+        }
+    }
+
+    void completeSend(uint64_t key, int result) {
+        auto it = sockets.find(key);
+        if (it == sockets.end()) return;
+        Socket& socket = it->second;
+        socket.send_pending = false;
+
+        if (socket.closing) {
+            releaseIfIdle(key);
+            return;
+        }
+        if (result == -EINTR || result == -EAGAIN) {
+            queueSend(key, socket);
+            return;
+        }
+        if (result < 0) {
+            handler->onFailed(key);
+            return;
+        }
+
+        socket.sent += static_cast<size_t>(result);
+        if (socket.sent < socket.send_size) {
+            queueSend(key, socket);
+        } else {
+            socket.send_data = nullptr;
+            handler->onSent(key);
+        }
+    }
+
+    bool drained() const {
+        if (wake_pending) return false;
+        for (const auto& entry : sockets) {
+            if (entry.second.receive_pending || entry.second.send_pending) return false;
+        }
+        return true;
+    }
+
+    // A completion after the loop has stopped: only its operation is done
+    void retire(const io_uring_cqe& cqe) {
+        auto operation = static_cast<Operation>(cqe.user_data & ((1u << kOperationBits) - 1));
+        if (operation == WAKE) {
+            wake_pending = false;
+            return;
+        }
+        auto it = sockets.find(cqe.user_data >> kOperationBits);
+        if (it == sockets.end()) return;
+        if (operation == RECEIVE) it->second.receive_pending = false;
+        if (operation == SEND) it->second.send_pending = false;
+    }
+
+    void releaseIfIdle(uint64_t key) {
+        auto it = sockets.find(key);
+        if (it == sockets.end() || it->second.receive_pending || it->second.send_pending) return;
+
+        if (it->second.buffer_index >= 0) free_buffers.push_back(it->second.buffer_index);
+        ::close(it->second.fd);
+        sockets.erase(it);
+    }
+};
+
+} // namespace
+
+std::unique_ptr<IoBackend> makeIoBackend(IoBackendKind kind, int listen_fd) {
+    if (kind == IoBackendKind::EPOLL) {
+        return std::make_unique<EpollBackend>(listen_fd);
+    }
+    try {
+        return UringBackend::create(listen_fd);
+    } catch (const std::exception& e) {
+        // Only AUTO falls back; an explicit request fails the server's startup
+        if (kind == IoBackendKind::URING) {
+            throw std::runtime_error(std::string("io_uring unavailable: ") + e.what());
+        }
+        std::cerr << "io_uring unavailable (" << e.what() << "), using epoll\n";
+    }
+    return std::make_unique<EpollBackend>(listen_fd);
+}
+
+std::string readFileContents(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) < 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat " + path + ": " + std::strerror(errno));
+    }
+
+    std::string contents(static_cast<size_t>(info.st_size), '\0');
+    constexpr size_t kChunkSize = 1024 * 1024;
+    constexpr unsigned kInFlight = 8;
+    size_t done = 0;
+
+    try {
+        Uring ring(kInFlight);
+        if (contents.size() <= kChunkSize || !ring.supports({IORING_OP_READ})) {
+            throw std::runtime_error("not worth it");
+        }
+
+        size_t next_offset = 0;
+        unsigned queued = 0;
+        unsigned completed = 0;
+        bool failed = false;
+        auto collect = [&](const io_uring_cqe& cqe) {
+            completed++;
+            size_t expected = cqe.user_data & 0xffffffffu;
+            if (cqe.res < 0 || static_cast<size_t>(cqe.res) != expected) {
+                failed = true;  // short or failed read: finish with pread
+            } else {
+                done += expected;
+            }
+        };
+
+        try {
+            while (!failed && (next_offset < contents.size() || completed < queued)) {
+                while (queued - completed < kInFlight && next_offset < contents.size()) {
+                    size_t length = std::min(kChunkSize, contents.size() - next_offset);
+                    io_uring_sqe* sqe = ring.next();
+                    sqe->opcode = IORING_OP_READ;
+                    sqe->fd = fd;
+                    sqe->addr = reinterpret_cast<uint64_t>(&contents[next_offset]);
+                    sqe->len = static_cast<uint32_t>(length);
+                    sqe->off = next_offset;
+                    sqe->user_data = (static_cast<uint64_t>(next_offset) << 32) | length;
+                    next_offset += length;
+                    queued++;
+                }
+
+                ring.submit(1);
+                ring.reap(collect);
+            }
+        } catch (const std::exception&) {
+            failed = true;
+        }
+
+        // Reads the kernel has taken keep writing into contents until they
+        // complete, even once the ring is closed, so none may be left in
+        // flight when pread takes over or the string is returned
+        while (completed < ring.submitted()) {
+            if (ring.reap(collect) == 0) ring.waitForCompletion();
+        }
+        if (failed) done = 0;
+    } catch (const std::exception&) {
+        done = 0;
+    }
+
+    if (done != contents.size()) {
+        size_t offset = 0;
+        while (offset < contents.size()) {
+            ssize_t count = ::pread(fd, &contents[offset], contents.size() - offset,
+                                    static_cast<off_t>(offset));
+            if (count < 0 && errno == EINTR) continue;
+            if (count <= 0) {
+                ::close(fd);
+                throw std::runtime_error("Cannot read " + path + ": " + std::strerror(errno));
+            }
+            offset += static_cast<size_t>(count);
+        }
+    }
+
+    ::close(fd);
+    return contents;
+}
+
+} // namespace AIEngine
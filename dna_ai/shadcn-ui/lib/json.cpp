@@ -0,0 +1,438 @@
+#include "ai_engine/json.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "ai_engine/trace.h"
+#include "multiversion.h"
+
+// SSE2 string scanning in the request decoder
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace AIEngine {
+namespace Json {
+
+// Offset of the first '"', '\\' or control character in data[0, size),
+// or size if there is none; the hot loop of string scanning
+#ifdef AI_ENGINE_MULTIVERSION
+__attribute__((target("default")))
+#endif
+inline size_t findStringSpecial(const char* data, size_t size) {
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i space = _mm_set1_epi8(0x20);
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        // Unsigned c < 0x20 is min(c, 0x20) != 0x20
+        __m128i control = _mm_xor_si128(_mm_cmpeq_epi8(_mm_min_epu8(chunk, space), space),
+                                        _mm_set1_epi8(-1));
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                                    _mm_cmpeq_epi8(chunk, backslash)), control);
+        int mask = _mm_movemask_epi8(special);
+        if (mask != 0) return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+    }
+#else
+    // SWAR: eight bytes per step, flagging bytes equal to '"' or '\\' or below 0x20
+    constexpr uint64_t kOnes = 0x0101010101010101ULL;
+    constexpr uint64_t kHighs = 0x8080808080808080ULL;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        uint64_t quotes = word ^ (kOnes * '"');
+        uint64_t slashes = word ^ (kOnes * '\\');
+        uint64_t special = ((quotes - kOnes) & ~quotes) | ((slashes - kOnes) & ~slashes) |
+                           ((word - kOnes * 0x20) & ~word);
+        special &= kHighs;
+        if (special != 0) break;  // locate it bytewise below
+    }
+#endif
+    for (; i < size; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (c == '"' || c == '\\' || c < 0x20) return i;
+    }
+    return size;
+}
+
+#ifdef AI_ENGINE_MULTIVERSION
+// AVX2 version of findStringSpecial, bound by ifunc on x86-64-v3 and up
+__attribute__((target("arch=x86-64-v3")))
+inline size_t findStringSpecial(const char* data, size_t size) {
+    size_t i = 0;
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i space = _mm256_set1_epi8(0x20);
+    for (; i + 32 <= size; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i control = _mm256_xor_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(chunk, space), space),
+                                           _mm256_set1_epi8(-1));
+        __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote),
+                                                          _mm256_cmpeq_epi8(chunk, backslash)), control);
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(special));
+        if (mask != 0) return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+    for (; i < size; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (c == '"' || c == '\\' || c < 0x20) return i;
+    }
+    return size;
+}
+#endif
+
+inline int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+inline uint32_t parseHex4(const char* digits) {
+    uint32_t code = 0;
+    for (int i = 0; i < 4; ++i) {
+        code = (code << 4) | static_cast<uint32_t>(hexDigit(digits[i]));
+    }
+    return code;
+}
+
+inline void appendUtf8(std::string& out, uint32_t code) {
+    if (code < 0x80) {
+        out.push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+}
+void Value::decodeTo(std::string& out) const {
+    if (!escaped) {
+        out.append(raw);
+        return;
+    }
+
+    out.reserve(out.size() + raw.size());
+    size_t pos = 0;
+    while (pos < raw.size()) {
+        size_t run = raw.find('\\', pos);
+        if (run == std::string_view::npos) run = raw.size();
+        out.append(raw.substr(pos, run - pos));
+        if (run == raw.size()) break;
+
+        char escape = raw[run + 1];
+        pos = run + 2;
+        switch (escape) {
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {
+                uint32_t code = parseHex4(raw.data() + pos);
+                pos += 4;
+                if (code >= 0xD800 && code <= 0xDBFF) {
+                    uint32_t low = parseHex4(raw.data() + pos + 2);
+                    pos += 6;
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(out, code);
+                break;
+            }
+            default: out.push_back(escape); break;  // '"', '\\' and '/'
+        }
+    }
+}
+
+bool Parser::parseObject(Object& object) {
+    skipWhitespace();
+    if (!consume('{')) return false;
+    skipWhitespace();
+    if (consume('}')) return finish();
+
+    while (true) {
+        Value key;
+        skipWhitespace();
+        if (!scanString(key)) return false;
+        skipWhitespace();
+        if (!consume(':')) return false;
+        skipWhitespace();
+
+        std::string_view name = key.raw;
+        if (key.escaped) {
+            object.decoded_keys.emplace_back();
+            key.decodeTo(object.decoded_keys.back());
+            name = object.decoded_keys.back();
+        }
+        object.members.emplace_back(name, Value());
+        if (!parseValue(object.members.back().second, 0)) return false;
+
+        skipWhitespace();
+        if (consume(',')) continue;
+        if (consume('}')) return finish();
+        return false;
+    }
+}
+
+bool Parser::finish() {
+    skipWhitespace();
+    return pos == text.size();
+}
+
+void Parser::skipWhitespace() {
+    while (pos < text.size() &&
+           (text[pos] == ' ' || text[pos] == '\n' || text[pos] == '\r' || text[pos] == '\t')) {
+        pos++;
+    }
+}
+
+bool Parser::consume(char expected) {
+    if (pos < text.size() && text[pos] == expected) {
+        pos++;
+        return true;
+    }
+    return false;
+}
+
+bool Parser::consumeWord(std::string_view word) {
+    if (text.substr(pos, word.size()) != word) return false;
+    pos += word.size();
+    return true;
+}
+
+bool Parser::parseValue(Value& value, int depth) {
+    if (depth > kMaxDepth || pos >= text.size()) return false;
+
+    char c = text[pos];
+    if (c == '"') {
+        return scanString(value);
+    }
+    if (c == '{' || c == '[') {
+        value.kind = Value::Kind::OTHER;
+        return skipContainer(depth);
+    }
+    if (consumeWord("true")) {
+        value.kind = Value::Kind::BOOLEAN;
+        value.boolean = true;
+        return true;
+    }
+    if (consumeWord("false")) {
+        value.kind = Value::Kind::BOOLEAN;
+        value.boolean = false;
+        return true;
+    }
+    if (consumeWord("null")) {
+        value.kind = Value::Kind::NUL;
+        return true;
+    }
+    return parseNumber(value);
+}
+
+bool Parser::parseNumber(Value& value) {
+    const char* first = text.data() + pos;
+    const char* last = text.data() + text.size();
+    if (first == last || *first == '+') return false;
+
+    auto result = std::from_chars(first, last, value.number);
+    if (result.ec != std::errc()) return false;
+    pos += static_cast<size_t>(result.ptr - first);
+    value.kind = Value::Kind::NUMBER;
+    return true;
+}
+
+bool Parser::skipContainer(int depth) {
+    char close = text[pos] == '{' ? '}' : ']';
+    bool is_object = close == '}';
+    pos++;
+    skipWhitespace();
+    if (consume(close)) return true;
+
+    while (true) {
+        skipWhitespace();
+        if (is_object) {
+            Value key;
+            if (!scanString(key)) return false;
+            skipWhitespace();
+            if (!consume(':')) return false;
+            skipWhitespace();
+        }
+        Value ignored;
+        if (!parseValue(ignored, depth + 1)) return false;
+        skipWhitespace();
+        if (consume(',')) continue;
+        return consume(close);
+    }
+}
+
+bool Parser::scanString(Value& value) {
+    if (!consume('"')) return false;
+    size_t start = pos;
+    value.kind = Value::Kind::STRING;
+    value.escaped = false;
+
+    while (true) {
+        pos += findStringSpecial(text.data() + pos, text.size() - pos);
+        if (pos >= text.size()) return false;
+
+        char c = text[pos];
+        if (c == '"') {
+            value.raw = text.substr(start, pos - start);
+            pos++;
+            return true;
+        }
+        if (c != '\\') return false;  // unescaped control character
+
+        value.escaped = true;
+        if (!validateEscape()) return false;
+    }
+}
+
+bool Parser::validateEscape() {
+    if (pos + 1 >= text.size()) return false;
+    char escape = text[pos + 1];
+    pos += 2;
+
+    switch (escape) {
+        case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+            return true;
+        case 'u':
+            break;
+        default:
+            return false;
+    }
+
+    uint32_t code;
+    if (!hex4(code)) return false;
+    if (code >= 0xD800 && code <= 0xDBFF) {
+        uint32_t low;
+        if (!consumeWord("\\u") || !hex4(low) || low < 0xDC00 || low > 0xDFFF) return false;
+    } else if (code >= 0xDC00 && code <= 0xDFFF) {
+        return false;
+    }
+    return true;
+}
+
+bool Parser::hex4(uint32_t& code) {
+    if (pos + 4 > text.size()) return false;
+    for (size_t i = pos; i < pos + 4; ++i) {
+        if (hexDigit(text[i]) < 0) return false;
+    }
+    code = parseHex4(text.data() + pos);
+    pos += 4;
+    return true;
+}
+
+} // namespace Json
+
+bool requestFromJson(std::string_view body, RequestType type, CodeRequest& request,
+                     bool& stream, std::string& error) {
+    AI_TRACE_SCOPE("requestFromJson");
+    Json::Object fields;
+    if (!Json::Parser(body).parseObject(fields)) {
+        error = "Request body is not a valid JSON object";
+        return false;
+    }
+
+    auto text = [&fields](const char* name, std::string& out) {
+        const Json::Value* value = fields.find(name);
+        if (value != nullptr && value->kind == Json::Value::Kind::STRING) {
+            out.clear();
+            value->decodeTo(out);
+        }
+    };
+    auto number = [&fields](const char* name, double fallback) {
+        const Json::Value* value = fields.find(name);
+        return value != nullptr && value->kind == Json::Value::Kind::NUMBER ? value->number : fallback;
+    };
+
+    if (const Json::Value* value = fields.find("type")) {
+        std::string name;
+        if (value->kind == Json::Value::Kind::STRING) value->decodeTo(name);
+        if (name == "generate") type = RequestType::GENERATE_CODE;
+        else if (name == "analyze") type = RequestType::ANALYZE_CODE;
+        else if (name == "execute") type = RequestType::EXECUTE_CODE;
+        else if (name == "optimize") type = RequestType::OPTIMIZE_CODE;
+        else {
+            error = "Unknown request type";
+            return false;
+        }
+    }
+
+    request.type = type;
+    std::string language = "python";
+    text("language", language);
+    request.language = stringToLanguage(language);
+
+    if (type == RequestType::ANALYZE_CODE) {
+        text("code", request.context);
+    } else {
+        if (fields.find("prompt") == nullptr) {
+            error = "Missing required field: prompt";
+            return false;
+        }
+        text("prompt", request.prompt);
+        text("context", request.context);
+        // Converting a NaN or a value out of range is undefined, so those
+        // are malformed rather than clamped
+        double max_tokens = number("max_tokens", request.max_tokens);
+        if (!(max_tokens >= std::numeric_limits<int>::min() && max_tokens <= std::numeric_limits<int>::max())) {
+            error = "Invalid field: max_tokens";
+            return false;
+        }
+        double temperature = number("temperature", request.temperature);
+        if (!(std::fabs(temperature) <= std::numeric_limits<float>::max())) {
+            error = "Invalid field: temperature";
+            return false;
+        }
+        request.max_tokens = static_cast<int>(max_tokens);
+        request.temperature = static_cast<float>(temperature);
+    }
+
+    const Json::Value* value = fields.find("stream");
+    stream = value != nullptr && value->kind == Json::Value::Kind::BOOLEAN && value->boolean;
+    return true;
+}
+
+std::string responseToJson(const CodeResponse& response) {
+    std::string out;
+    out.reserve(response.code.size() + response.explanation.size() + 256);
+    out += "{\"success\":";
+    out += response.error.empty() ? "true" : "false";
+    out += ",\"data\":{\"code\":";
+    Json::appendString(out, response.code);
+    out += ",\"explanation\":";
+    Json::appendString(out, response.explanation);
+    out += ",\"confidence\":";
+    out += std::to_string(response.confidence);
+    out += ",\"execution_result\":";
+    Json::appendString(out, response.execution_result);
+    out += "},\"error\":";
+    if (response.error.empty()) {
+        out += "null";
+    } else {
+        Json::appendString(out, response.error);
+    }
+    out += ",\"processing_time\":";
+    out += std::to_string(response.processing_time.count() / 1000.0);
+    out += "}";
+    return out;
+}
+
+std::string errorToJson(std::string_view error) {
+    std::string out = "{\"success\":false,\"data\":null,\"error\":";
+    Json::appendString(out, error);
+    out += "}";
+    return out;
+}
+
+} // namespace AIEngine
@@ -0,0 +1,102 @@
+#include "ai_engine/kernels.h"
+
+#include "multiversion.h"
+
+// SSE2 case conversion in toLower
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace AIEngine {
+namespace Kernels {
+
+const char* isaLevel() {
+#ifdef AI_ENGINE_MULTIVERSION
+    if (__builtin_cpu_supports("x86-64-v4")) return "x86-64-v4";
+    if (__builtin_cpu_supports("x86-64-v3")) return "x86-64-v3";
+    if (__builtin_cpu_supports("x86-64-v2")) return "x86-64-v2";
+    return "x86-64";
+#else
+    return "generic";
+#endif
+}
+
+// Dot product of a and b over n floats, the inner loop of every layer.
+// Independent lane sums let the compiler vectorise it at any width without
+// reassociating a single running sum; every clone adds in the same order.
+AI_TARGET_CLONES
+float dot(const float* a, const float* b, size_t n) {
+    constexpr size_t kLanes = 16;
+    float lanes[kLanes] = {};
+    size_t j = 0;
+    for (; j + kLanes <= n; j += kLanes) {
+        for (size_t k = 0; k < kLanes; ++k) {
+            lanes[k] += a[j + k] * b[j + k];
+        }
+    }
+
+    float sum = 0.0f;
+    for (size_t k = 0; k < kLanes; ++k) {
+        sum += lanes[k];
+    }
+    for (; j < n; ++j) {
+        sum += a[j] * b[j];
+    }
+    return sum;
+}
+
+namespace {
+
+// Sixteen bytes per step: bytes between 'A' and 'Z' (a signed compare
+// leaves bytes >= 0x80 alone) get 0x20 added
+#ifdef AI_ENGINE_MULTIVERSION
+__attribute__((target("default")))
+#endif
+inline void lowerAscii(char* data, size_t n) {
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i before_a = _mm_set1_epi8('A' - 1);
+    const __m128i after_z = _mm_set1_epi8('Z' + 1);
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    for (; i + 16 <= n; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(chunk, before_a), _mm_cmplt_epi8(chunk, after_z));
+        chunk = _mm_add_epi8(chunk, _mm_and_si128(upper, case_bit));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), chunk);
+    }
+#endif
+    for (; i < n; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (static_cast<unsigned>(c - 'A') < 26u) data[i] = static_cast<char>(c + 0x20);
+    }
+}
+
+#ifdef AI_ENGINE_MULTIVERSION
+// AVX2 version of lowerAscii, bound by ifunc on x86-64-v3 and up
+__attribute__((target("arch=x86-64-v3")))
+inline void lowerAscii(char* data, size_t n) {
+    size_t i = 0;
+    const __m256i before_a = _mm256_set1_epi8('A' - 1);
+    const __m256i after_z = _mm256_set1_epi8('Z' + 1);
+    const __m256i case_bit = _mm256_set1_epi8(0x20);
+    for (; i + 32 <= n; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(chunk, before_a), _mm256_cmpgt_epi8(after_z, chunk));
+        chunk = _mm256_add_epi8(chunk, _mm256_and_si256(upper, case_bit));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), chunk);
+    }
+    for (; i < n; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (static_cast<unsigned>(c - 'A') < 26u) data[i] = static_cast<char>(c + 0x20);
+    }
+}
+#endif
+
+} // namespace
+
+void toLower(char* data, size_t n) {
+    lowerAscii(data, n);
+}
+
+} // namespace Kernels
+} // namespace AIEngine
@@ -0,0 +1,375 @@
+#include "ai_engine/metrics.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace AIEngine {
+namespace Metrics {
+
+PerfCounterGroup::PerfCounterGroup() {
+    std::fill(std::begin(fds), std::end(fds), -1);
+}
+
+PerfCounterGroup::~PerfCounterGroup() {
+    close();
+}
+
+bool PerfCounterGroup::open(std::string& error) {
+    static const uint64_t kConfigs[kCounterCount] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    for (size_t i = 0; i < kCounterCount; ++i) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = kConfigs[i];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        attr.disabled = i == 0 ? 1 : 0;  // the leader starts the whole group
+
+        int group = i == 0 ? -1 : fds[0];
+        fds[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, group, PERF_FLAG_FD_CLOEXEC));
+        if (fds[i] < 0) {
+            error = std::string("perf_event_open(") + counterName(static_cast<Counter>(i)) + "): " +
+                    std::strerror(errno);
+            close();
+            return false;
+        }
+    }
+
+    ::ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ::ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+bool PerfCounterGroup::read(uint64_t values[kCounterCount]) const {
+    if (fds[0] < 0) return false;
+    uint64_t buffer[1 + kCounterCount];
+    if (::read(fds[0], buffer, sizeof(buffer)) != static_cast<ssize_t>(sizeof(buffer)) ||
+        buffer[0] != kCounterCount) {
+        return false;
+    }
+    std::copy(buffer + 1, buffer + 1 + kCounterCount, values);
+    return true;
+}
+
+void PerfCounterGroup::close() {
+    for (int& fd : fds) {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+}
+
+Shard::Shard() {
+    for (auto& per_type : counters) {
+        for (auto& per_stage : per_type) {
+            for (auto& total : per_stage) total.store(0, std::memory_order_relaxed);
+        }
+    }
+    for (auto& per_type : counted) {
+        for (auto& total : per_type) total.store(0, std::memory_order_relaxed);
+    }
+    for (auto& per_type : histograms) {
+        for (auto& histogram : per_type) {
+            for (auto& count : histogram.counts) count.store(0, std::memory_order_relaxed);
+            histogram.sum.store(0, std::memory_order_relaxed);
+            histogram.max.store(0, std::memory_order_relaxed);
+        }
+    }
+    for (size_t i = 0; i < kRequestTypeCount; ++i) {
+        requests[i].store(0, std::memory_order_relaxed);
+        errors[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void Shard::absorb(const Shard& other) {
+    for (size_t type = 0; type < kRequestTypeCount; ++type) {
+        bump(requests[type], other.requests[type].load(std::memory_order_relaxed));
+        bump(errors[type], other.errors[type].load(std::memory_order_relaxed));
+
+        for (size_t stage = 0; stage < kStageCount; ++stage) {
+            Histogram& target = histograms[type][stage];
+            const Histogram& source = other.histograms[type][stage];
+            for (size_t i = 0; i < Buckets::kCount; ++i) {
+                bump(target.counts[i], source.counts[i].load(std::memory_order_relaxed));
+            }
+            bump(target.sum, source.sum.load(std::memory_order_relaxed));
+            target.max.store(std::max(target.max.load(std::memory_order_relaxed),
+                                      source.max.load(std::memory_order_relaxed)),
+                             std::memory_order_relaxed);
+
+            bump(counted[type][stage], other.counted[type][stage].load(std::memory_order_relaxed));
+            for (size_t i = 0; i < kCounterCount; ++i) {
+                bump(counters[type][stage][i], other.counters[type][stage][i].load(std::memory_order_relaxed));
+            }
+        }
+    }
+}
+
+uint64_t HistogramSnapshot::percentile(double q) const {
+    if (count == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(count)));
+    rank = std::max<uint64_t>(1, std::min(rank, count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) return std::min(Buckets::upperBound(i), max);
+    }
+    return max;
+}
+
+void Registry::retire(Shard* shard) {
+    shard->perf.close();
+    std::lock_guard<std::mutex> lock(shards_mutex);
+    retired.absorb(*shard);
+    for (auto it = shards.begin(); it != shards.end(); ++it) {
+        if (it->get() == shard) {
+            // Order does not matter to snapshot()
+            std::swap(*it, shards.back());
+            shards.pop_back();
+            break;
+        }
+    }
+}
+
+Snapshot Registry::snapshot() {
+    Snapshot result;
+    result.uptime_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    std::lock_guard<std::mutex> lock(shards_mutex);
+    std::vector<const Shard*> all{&retired};
+    for (const auto& shard : shards) all.push_back(shard.get());
+    for (const Shard* shard : all) {
+        for (size_t type = 0; type < kRequestTypeCount; ++type) {
+            result.requests[type] += shard->requests[type].load(std::memory_order_relaxed);
+            result.errors[type] += shard->errors[type].load(std::memory_order_relaxed);
+
+            for (size_t stage = 0; stage < kStageCount; ++stage) {
+                const Shard::Histogram& source = shard->histograms[type][stage];
+                HistogramSnapshot& target = result.histograms[type][stage];
+                for (size_t i = 0; i < Buckets::kCount; ++i) {
+                    uint64_t count = source.counts[i].load(std::memory_order_relaxed);
+                    target.counts[i] += count;
+                    target.count += count;
+                }
+                target.sum += source.sum.load(std::memory_order_relaxed);
+                target.max = std::max(target.max, source.max.load(std::memory_order_relaxed));
+
+                result.counted[type][stage] += shard->counted[type][stage].load(std::memory_order_relaxed);
+                for (size_t i = 0; i < kCounterCount; ++i) {
+                    result.counters[type][stage][i] +=
+                        shard->counters[type][stage][i].load(std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+bool enableHardwareCounters(std::string& error) {
+    PerfCounterGroup probe;
+    if (!probe.open(error)) return false;
+    hardwareCountersFlag().store(true, std::memory_order_relaxed);
+    return true;
+}
+
+std::string formatReport(const Snapshot& snapshot) {
+    std::ostringstream out;
+    out << std::fixed;
+    out.precision(1);
+
+    auto micros = [](uint64_t nanoseconds) { return static_cast<double>(nanoseconds) / 1000.0; };
+
+    for (size_t type = 0; type < kRequestTypeCount; ++type) {
+        if (snapshot.requests[type] == 0) continue;
+        auto request_type = static_cast<RequestType>(type);
+
+        out << requestTypeName(request_type) << ": " << snapshot.requests[type] << " requests, "
+            << snapshot.errors[type] << " errors, "
+            << (snapshot.uptime_seconds > 0 ? snapshot.requests[type] / snapshot.uptime_seconds : 0.0)
+            << " req/s\n";
+
+        for (size_t stage = 0; stage < kStageCount; ++stage) {
+            const HistogramSnapshot& histogram = snapshot.histograms[type][stage];
+            if (histogram.count == 0) continue;
+            out << "  " << stageName(static_cast<Stage>(stage)) << " (us): "
+                << "p50 " << micros(histogram.percentile(0.50))
+                << "  p99 " << micros(histogram.percentile(0.99))
+                << "  p999 " << micros(histogram.percentile(0.999))
+                << "  max " << micros(histogram.max)
+                << "  mean " << micros(histogram.sum / histogram.count) << "\n";
+
+            uint64_t runs = snapshot.counted[type][stage];
+            if (runs == 0) continue;
+            const uint64_t* totals = snapshot.counters[type][stage];
+            double cycles = static_cast<double>(totals[static_cast<size_t>(Counter::CYCLES)]);
+            double instructions = static_cast<double>(totals[static_cast<size_t>(Counter::INSTRUCTIONS)]);
+            out << "    per run: " << cycles / runs << " cycles  " << instructions / runs << " instructions  "
+                << "IPC " << (cycles > 0 ? instructions / cycles : 0.0) << "  "
+                << static_cast<double>(totals[static_cast<size_t>(Counter::CACHE_MISSES)]) / runs
+                << " cache misses  "
+                << static_cast<double>(totals[static_cast<size_t>(Counter::BRANCH_MISSES)]) / runs
+                << " branch misses\n";
+        }
+    }
+    return out.str();
+}
+
+bool memoryUsage(uint64_t& resident_bytes, uint64_t& virtual_bytes) {
+    std::ifstream statm("/proc/self/statm");
+    uint64_t virtual_pages = 0;
+    uint64_t resident_pages = 0;
+    if (!(statm >> virtual_pages >> resident_pages)) return false;
+
+    uint64_t page_size = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+    resident_bytes = resident_pages * page_size;
+    virtual_bytes = virtual_pages * page_size;
+    return true;
+}
+
+std::string formatPrometheus(const Snapshot& snapshot) {
+    static const double kBounds[] = {
+        1e-6, 2.5e-6, 5e-6, 1e-5, 2.5e-5, 5e-5, 1e-4, 2.5e-4, 5e-4,
+        1e-3, 2.5e-3, 5e-3, 1e-2, 2.5e-2, 5e-2, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0
+    };
+
+    std::string out;
+    out.reserve(64 * 1024);
+    char line[256];
+
+    auto append = [&out, &line](int length) {
+        out.append(line, static_cast<size_t>(std::max(0, std::min<int>(length, sizeof(line) - 1))));
+    };
+
+    out += "# HELP ai_engine_requests_total Requests processed by the engine.\n";
+    out += "# TYPE ai_engine_requests_total counter\n";
+    for (size_t type = 0; type < kRequestTypeCount; ++type) {
+        append(std::snprintf(line, sizeof(line), "ai_engine_requests_total{type=\"%s\"} %llu\n",
+                             requestTypeName(static_cast<RequestType>(type)),
+                             static_cast<unsigned long long>(snapshot.requests[type])));
+    }
+
+    out += "# HELP ai_engine_request_errors_total Requests that returned an error.\n";
+    out += "# TYPE ai_engine_request_errors_total counter\n";
+    for (size_t type = 0; type < kRequestTypeCount; ++type) {
+        append(std::snprintf(line, sizeof(line), "ai_engine_request_errors_total{type=\"%s\"} %llu\n",
+                             requestTypeName(static_cast<RequestType>(type)),
+                             static_cast<unsigned long long>(snapshot.errors[type])));
+    }
+
+    out += "# HELP ai_engine_stage_duration_seconds Time spent per request stage.\n";
+    out += "# TYPE ai_engine_stage_duration_seconds histogram\n";
+    for (size_t type = 0; type < kRequestTypeCount; ++type) {
+        const char* type_name = requestTypeName(static_cast<RequestType>(type));
+        for (size_t stage = 0; stage < kStageCount; ++stage) {
+            const HistogramSnapshot& histogram = snapshot.histograms[type][stage];
+            if (histogram.count == 0) continue;
+            const char* stage_name = stageName(static_cast<Stage>(stage));
+
+            size_t bucket = 0;
+            uint64_t cumulative = 0;
+            for (double bound : kBounds) {
+                uint64_t limit = static_cast<uint64_t>(bound * 1e9);
+                while (bucket < Buckets::kCount && Buckets::upperBound(bucket) <= limit) {
+                    cumulative += histogram.counts[bucket++];
+                }
+                append(std::snprintf(line, sizeof(line),
+                                     "ai_engine_stage_duration_seconds_bucket{type=\"%s\",stage=\"%s\",le=\"%g\"} %llu\n",
+                                     type_name, stage_name, bound, static_cast<unsigned long long>(cumulative)));
+            }
+            append(std::snprintf(line, sizeof(line),
+                                 "ai_engine_stage_duration_seconds_bucket{type=\"%s\",stage=\"%s\",le=\"+Inf\"} %llu\n"
+                                 "ai_engine_stage_duration_seconds_sum{type=\"%s\",stage=\"%s\"} %.9f\n"
+                                 "ai_engine_stage_duration_seconds_count{type=\"%s\",stage=\"%s\"} %llu\n",
+                                 type_name, stage_name, static_cast<unsigned long long>(histogram.count),
+                                 type_name, stage_name, static_cast<double>(histogram.sum) / 1e9,
+                                 type_name, stage_name, static_cast<unsigned long long>(histogram.count)));
+        }
+    }
+
+    bool any_counters = false;
+    for (size_t type = 0; type < kRequestTypeCount; ++type) {
+        for (size_t stage = 0; stage < kStageCount; ++stage) {
+            any_counters = any_counters || snapshot.counted[type][stage] > 0;
+        }
+    }
+    if (any_counters) {
+        out += "# HELP ai_engine_stage_hardware_events_total Hardware counter totals per request stage.\n";
+        out += "# TYPE ai_engine_stage_hardware_events_total counter\n";
+        for (size_t type = 0; type < kRequestTypeCount; ++type) {
+            const char* type_name = requestTypeName(static_cast<RequestType>(type));
+            for (size_t stage = 0; stage < kStageCount; ++stage) {
+                if (snapshot.counted[type][stage] == 0) continue;
+                const char* stage_name = stageName(static_cast<Stage>(stage));
+                for (size_t i = 0; i < kCounterCount; ++i) {
+                    append(std::snprintf(line, sizeof(line),
+                                         "ai_engine_stage_hardware_events_total{type=\"%s\",stage=\"%s\",event=\"%s\"} %llu\n",
+                                         type_name, stage_name, counterName(static_cast<Counter>(i)),
+                                         static_cast<unsigned long long>(snapshot.counters[type][stage][i])));
+                }
+            }
+        }
+
+        out += "# HELP ai_engine_stage_hardware_samples_total Stage runs covered by the hardware counters.\n";
+        out += "# TYPE ai_engine_stage_hardware_samples_total counter\n";
+        for (size_t type = 0; type < kRequestTypeCount; ++type) {
+            for (size_t stage = 0; stage < kStageCount; ++stage) {
+                if (snapshot.counted[type][stage] == 0) continue;
+                append(std::snprintf(line, sizeof(line),
+                                     "ai_engine_stage_hardware_samples_total{type=\"%s\",stage=\"%s\"} %llu\n",
+                                     requestTypeName(static_cast<RequestType>(type)),
+                                     stageName(static_cast<Stage>(stage)),
+                                     static_cast<unsigned long long>(snapshot.counted[type][stage])));
+            }
+        }
+    }
+
+    auto gauge = [&out](const char* name, const char* help, const std::string& value) {
+        out += "# HELP ";
+        out += name;
+        out += " ";
+        out += help;
+        out += "\n# TYPE ";
+        out += name;
+        out += " gauge\n";
+        out += name;
+        out += " ";
+        out += value;
+        out += "\n";
+    };
+
+    const Gauges& current = gauges();
+    gauge("ai_engine_queue_depth", "Requests waiting for a worker thread.",
+          std::to_string(current.queued.load(std::memory_order_relaxed)));
+    gauge("ai_engine_active_requests", "Requests running on worker threads.",
+          std::to_string(current.active.load(std::memory_order_relaxed)));
+    gauge("ai_engine_open_connections", "Open daemon and HTTP connections.",
+          std::to_string(current.connections.load(std::memory_order_relaxed)));
+    gauge("ai_engine_worker_threads", "Worker threads across all pools.",
+          std::to_string(current.workers.load(std::memory_order_relaxed)));
+
+    uint64_t resident = 0;
+    uint64_t virtual_size = 0;
+    if (memoryUsage(resident, virtual_size)) {
+        gauge("process_resident_memory_bytes", "Resident memory size in bytes.", std::to_string(resident));
+        gauge("process_virtual_memory_bytes", "Virtual memory size in bytes.", std::to_string(virtual_size));
+    }
+    gauge("ai_engine_uptime_seconds", "Seconds since metrics collection started.",
+          std::to_string(snapshot.uptime_seconds));
+    return out;
+}
+
+} // namespace Metrics
+} // namespace AIEngine
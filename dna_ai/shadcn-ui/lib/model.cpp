@@ -0,0 +1,266 @@
+#include "ai_engine/model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <random>
+#include <sstream>
+
+#include "ai_engine/kernels.h"
+#include "ai_engine/trace.h"
+
+// JSON handling (you may need to install nlohmann/json)
+#ifdef HAS_JSON
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+#endif
+
+// TensorFlow C++ API (optional, requires TensorFlow C++ installation)
+#ifdef HAS_TENSORFLOW
+#include "tensorflow/cc/client/client_session.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/tensor.h"
+#endif
+
+// ONNX Runtime (optional, for running ONNX models)
+#ifdef HAS_ONNX
+#include <onnxruntime_cxx_api.h>
+#endif
+
+namespace AIEngine {
+
+namespace {
+
+// Process-wide components behind TokenProcessor::shared() and
+// NeuralNetwork::shared()
+std::mutex shared_mutex;
+std::shared_ptr<const TokenProcessor> shared_tokenizer;
+std::shared_ptr<const NeuralNetwork> shared_network;
+
+} // namespace
+
+void TokenProcessor::initializeVocab() {
+    // Basic programming tokens
+    std::vector<std::string> basic_tokens = {
+        "<pad>", "<unk>", "<start>", "<end>",
+        "def", "class", "if", "else", "for", "while", "return",
+        "int", "float", "string", "bool", "void",
+        "#include", "using", "namespace", "std",
+        "function", "var", "let", "const", "return",
+        "(", ")", "{", "}", "[", "]", ";", ":", ",", ".",
+        "+", "-", "*", "/", "=", "==", "!=", "<", ">", "<=", ">="
+    };
+
+    assignVocab(basic_tokens);
+}
+
+void TokenProcessor::assignVocab(const std::vector<std::string>& tokens) {
+    vocab.clear();
+    reverse_vocab.clear();
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        vocab[tokens[i]] = i;
+        reverse_vocab[i] = tokens[i];
+    }
+    vocab_size = tokens.size();
+}
+
+std::vector<std::string> TokenProcessor::vocabulary() const {
+    std::vector<std::string> tokens;
+    tokens.reserve(reverse_vocab.size());
+    for (const auto& entry : reverse_vocab) {
+        tokens.push_back(entry.second);
+    }
+    return tokens;
+}
+
+std::shared_ptr<const TokenProcessor> TokenProcessor::shared() {
+    std::lock_guard<std::mutex> lock(shared_mutex);
+    if (!shared_tokenizer) {
+        shared_tokenizer = std::make_shared<const TokenProcessor>();
+    }
+    return shared_tokenizer;
+}
+
+std::vector<int> TokenProcessor::tokenize(const std::string& text) const {
+    AI_TRACE_SCOPE("tokenize");
+    std::vector<int> tokens;
+    std::istringstream iss(text);
+    std::string word;
+    const int unk_token = vocab.at("<unk>");
+
+    while (iss >> word) {
+        auto it = vocab.find(word);
+        if (it != vocab.end()) {
+            tokens.push_back(it->second);
+        } else {
+            tokens.push_back(unk_token);
+        }
+    }
+
+    return tokens;
+}
+
+std::string TokenProcessor::detokenize(const std::vector<int>& tokens) const {
+    AI_TRACE_SCOPE("detokenize");
+    std::string result;
+    for (int token : tokens) {
+        auto it = reverse_vocab.find(token);
+        if (it != reverse_vocab.end()) {
+            if (!result.empty()) result += " ";
+            result += it->second;
+        }
+    }
+    return result;
+}
+
+NeuralNetwork::Layer::Layer(int input_size, int output_size, Activation act)
+    : inputs(input_size), outputs(output_size), kind(act), activation(activationFunction(act)) {
+    // Initialize weights with Xavier initialization
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    float limit = std::sqrt(6.0f / (input_size + output_size));
+    std::uniform_real_distribution<float> dis(-limit, limit);
+
+    // Weight rows followed by the biases, in one allocation
+    storage.resize(outputs * inputs + outputs);
+    float* values = storage.data();
+    float* bias_values = values + outputs * inputs;
+
+    for (size_t i = 0; i < outputs; ++i) {
+        for (size_t j = 0; j < inputs; ++j) {
+            values[i * inputs + j] = dis(gen);
+        }
+        bias_values[i] = dis(gen);
+    }
+    weights = values;
+    biases = bias_values;
+}
+
+NeuralNetwork::Layer::Layer(const LayerView& view)
+    : inputs(view.inputs), outputs(view.outputs), kind(view.activation),
+      activation(activationFunction(view.activation)), weights(view.weights), biases(view.biases) {}
+
+float (*NeuralNetwork::activationFunction(Activation kind))(float) {
+    switch (kind) {
+        case Activation::SIGMOID:
+            return sigmoid;
+        case Activation::TANH:
+            return tanh_activation;
+        case Activation::RELU:
+        default:
+            return relu;
+    }
+}
+
+NeuralNetwork::NeuralNetwork() {
+    // Simple transformer-like architecture for code generation
+    // Embedding layer (simulated)
+    layers.emplace_back(512, 256, Activation::RELU);
+    // Hidden layers
+    layers.emplace_back(256, 256, Activation::RELU);
+    layers.emplace_back(256, 256, Activation::RELU);
+    // Output layer
+    layers.emplace_back(256, 512, Activation::SIGMOID);
+}
+
+NeuralNetwork::NeuralNetwork(const std::vector<LayerView>& views, std::shared_ptr<const void> backing_memory)
+    : backing(std::move(backing_memory)) {
+    layers.reserve(views.size());
+    for (const LayerView& view : views) {
+        layers.emplace_back(view);
+    }
+}
+
+std::vector<NeuralNetwork::LayerView> NeuralNetwork::layerViews() const {
+    std::vector<LayerView> views;
+    views.reserve(layers.size());
+    for (const Layer& layer : layers) {
+        views.push_back(LayerView{layer.inputs, layer.outputs, layer.kind, layer.weights, layer.biases});
+    }
+    return views;
+}
+
+std::shared_ptr<const NeuralNetwork> NeuralNetwork::shared() {
+    std::lock_guard<std::mutex> lock(shared_mutex);
+    if (!shared_network) {
+        shared_network = std::make_shared<const NeuralNetwork>();
+    }
+    return shared_network;
+}
+
+bool NeuralNetwork::installShared(std::shared_ptr<const NeuralNetwork> network,
+                                  std::shared_ptr<const TokenProcessor> tokenizer) {
+    std::lock_guard<std::mutex> lock(shared_mutex);
+    if (shared_network || shared_tokenizer) return false;
+    shared_network = std::move(network);
+    shared_tokenizer = std::move(tokenizer);
+    return true;
+}
+
+std::vector<float> NeuralNetwork::forward(const std::vector<float>& input) const {
+    AI_TRACE_SCOPE("forward");
+    return forwardLayers(input, false);
+}
+
+std::vector<float> NeuralNetwork::forwardShallow(const std::vector<float>& input) const {
+    AI_TRACE_SCOPE("forwardShallow");
+    return forwardLayers(input, true);
+}
+
+std::vector<float> NeuralNetwork::forwardLayers(const std::vector<float>& input, bool skip_hidden) const {
+    static const char* const kLayerSpans[] = {
+        "forward.layer0", "forward.layer1", "forward.layer2", "forward.layer3",
+        "forward.layer4", "forward.layer5", "forward.layer6", "forward.layer7"
+    };
+    std::vector<float> current = input;
+
+    for (size_t index = 0; index < layers.size(); ++index) {
+        const Layer& layer = layers[index];
+        // Only square layers can be left out without changing the width
+        // the next layer reads
+        if (skip_hidden && index > 0 && index + 1 < layers.size() && layer.inputs == layer.outputs) {
+            continue;
+        }
+        AI_TRACE_SCOPE(index < 8 ? kLayerSpans[index] : "forward.layer");
+        std::vector<float> next(layer.outputs);
+        const size_t width = std::min(current.size(), layer.inputs);
+
+        for (size_t i = 0; i < layer.outputs; ++i) {
+            float sum = layer.biases[i] + Kernels::dot(current.data(), layer.row(i), width);
+            next[i] = layer.activation(sum);
+        }
+
+        current = std::move(next);
+    }
+
+    return current;
+}
+
+std::vector<std::vector<float>> NeuralNetwork::forwardBatch(const std::vector<std::vector<float>>& inputs) const {
+    AI_TRACE_SCOPE("forwardBatch");
+    constexpr size_t kBlock = 8;
+    std::vector<std::vector<float>> current = inputs;
+
+    for (const auto& layer : layers) {
+        std::vector<std::vector<float>> next(current.size(), std::vector<float>(layer.outputs));
+
+        for (size_t first = 0; first < current.size(); first += kBlock) {
+            size_t last = std::min(first + kBlock, current.size());
+            for (size_t i = 0; i < layer.outputs; ++i) {
+                const float* row = layer.row(i);
+                for (size_t b = first; b < last; ++b) {
+                    const std::vector<float>& in = current[b];
+                    float sum = layer.biases[i] + Kernels::dot(in.data(), row,
+                                                               std::min(in.size(), layer.inputs));
+                    next[b][i] = layer.activation(sum);
+                }
+            }
+        }
+
+        current = std::move(next);
+    }
+
+    return current;
+}
+
+} // namespace AIEngine
@@ -0,0 +1,20 @@
+// Internal to the library: hot kernels are compiled for each x86-64
+// microarchitecture level and the best one is bound at load time through
+// an ifunc, so a single generic binary still uses AVX2/AVX-512 where the
+// CPU has them. -DAI_ENGINE_NO_MULTIVERSION compiles them once for the
+// build's target.
+
+#ifndef AI_ENGINE_MULTIVERSION_H
+#define AI_ENGINE_MULTIVERSION_H
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__) && defined(__linux__) && \
+    !defined(AI_ENGINE_NO_MULTIVERSION)
+#define AI_ENGINE_MULTIVERSION 1
+#define AI_TARGET_CLONES __attribute__((target_clones("default", "arch=x86-64-v2", "arch=x86-64-v3", \
+                                                      "arch=x86-64-v4")))
+#include <immintrin.h>
+#else
+#define AI_TARGET_CLONES
+#endif
+
+#endif // AI_ENGINE_MULTIVERSION_H
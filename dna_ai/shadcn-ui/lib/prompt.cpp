@@ -0,0 +1,122 @@
+#include "ai_engine/prompt.h"
+
+#include <array>
+#include <vector>
+
+#include "ai_engine/kernels.h"
+#include "ai_engine/trace.h"
+
+namespace AIEngine {
+
+namespace {
+
+constexpr size_t kKeywordCount = static_cast<size_t>(PromptKeyword::KEYWORD_COUNT);
+
+constexpr std::string_view kKeywordTexts[kKeywordCount] = {
+    "calculate", "compute", "find", "sort", "search",
+    "create", "generate", "process", "convert", "parse",
+    "count", "number", "string", "text"
+};
+
+constexpr uint32_t kActionMask = (1u << (static_cast<unsigned>(PromptKeyword::PARSE) + 1)) - 1;
+
+// Aho-Corasick automaton over the keywords with a dense transition table:
+// 26 letters plus one column for every other byte, which leads back to the
+// root since no keyword contains it. Rows are 32 entries wide and hold the
+// offset of the next state's row, so a step is one add and one load.
+class KeywordAutomaton {
+private:
+    static constexpr size_t kAlphabet = 27;
+    static constexpr size_t kRowShift = 5;
+
+    std::vector<uint16_t> rows;     // next state's row offset per state and column
+    std::vector<uint32_t> matches;  // keywords ending at each state, via failure links too
+
+    static size_t column(unsigned char c) {
+        return static_cast<unsigned>(c - 'a') < 26u ? static_cast<size_t>(c - 'a') : 26;
+    }
+
+public:
+    KeywordAutomaton() {
+        // Trie of the keywords as state numbers; 0 stands for a missing edge
+        // until the failure links fill it in
+        std::vector<std::array<uint16_t, kAlphabet>> next(1);
+        matches.push_back(0);
+        for (size_t keyword = 0; keyword < kKeywordCount; ++keyword) {
+            uint16_t state = 0;
+            for (char c : kKeywordTexts[keyword]) {
+                size_t edge = column(static_cast<unsigned char>(c));
+                if (next[state][edge] == 0) {
+                    next[state][edge] = static_cast<uint16_t>(next.size());
+                    next.push_back({});
+                    matches.push_back(0);
+                }
+                state = next[state][edge];
+            }
+            matches[state] |= 1u << keyword;
+        }
+
+        // Breadth first, so a state's failure target is complete before it
+        std::vector<uint16_t> failure(next.size(), 0);
+        std::vector<uint16_t> queue;
+        for (uint16_t child : next[0]) {
+            if (child != 0) queue.push_back(child);
+        }
+        for (size_t head = 0; head < queue.size(); ++head) {
+            uint16_t state = queue[head];
+            matches[state] |= matches[failure[state]];
+            for (size_t edge = 0; edge < kAlphabet; ++edge) {
+                uint16_t child = next[state][edge];
+                if (child != 0) {
+                    failure[child] = next[failure[state]][edge];
+                    queue.push_back(child);
+                } else {
+                    next[state][edge] = next[failure[state]][edge];
+                }
+            }
+        }
+
+        rows.assign(next.size() << kRowShift, 0);
+        for (size_t state = 0; state < next.size(); ++state) {
+            for (size_t edge = 0; edge < kAlphabet; ++edge) {
+                rows[(state << kRowShift) + edge] = static_cast<uint16_t>(next[state][edge] << kRowShift);
+            }
+        }
+    }
+
+    uint32_t scan(std::string_view text) const {
+        const uint16_t* table = rows.data();
+        const uint32_t* found_at = matches.data();
+        uint32_t found = 0;
+        size_t row = 0;
+        for (char c : text) {
+            row = table[row + column(static_cast<unsigned char>(c))];
+            found |= found_at[row >> kRowShift];
+        }
+        return found;
+    }
+};
+
+const KeywordAutomaton& automaton() {
+    static const KeywordAutomaton instance;
+    return instance;
+}
+
+} // namespace
+
+std::string_view PromptFeatures::action() const {
+    uint32_t actions = keywords & kActionMask;
+    return actions ? kKeywordTexts[__builtin_ctz(actions)] : std::string_view();
+}
+
+PromptFeatures analyzePrompt(std::string_view prompt) {
+    AI_TRACE_SCOPE("analyzePrompt");
+    PromptFeatures features;
+    features.lowered.assign(prompt.data(), prompt.size());
+    Kernels::toLower(features.lowered.data(), features.lowered.size());
+    features.keywords = automaton().scan(features.lowered);
+    features.length = prompt.size();
+    return features;
+}
+
+} // namespace AIEngine
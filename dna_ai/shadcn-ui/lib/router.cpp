@@ -0,0 +1,148 @@
+#include "ai_engine/router.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "ai_engine/metrics.h"
+
+namespace AIEngine {
+
+namespace {
+
+// Typical latencies of each path until measurements replace them
+constexpr double kSeedCosts[Router::kPathCount] = {2.0, 190.0, 215.0};
+// Weight of a new measurement in the moving average
+constexpr double kCostSmoothing = 1.0 / 16.0;
+
+// Quality given up per microsecond of worker time at load 0.5. The price
+// grows as load / (1 - load), the M/M/1 factor by which extra service
+// time turns into waiting for everyone queued behind it.
+constexpr double kPricePerMicrosecond = 2e-4;
+
+// Templates cover prompts up to these sizes as well as the network does
+constexpr double kTemplatePromptLength = 50.0;
+constexpr double kTemplateContextLength = 100.0;
+
+constexpr float kTemplateQuality = 0.9f;
+constexpr float kNetworkQuality = 0.85f;
+// The shallow network's quality below the full one: small next to what a
+// template gives up on long prompts, or the ~25 us it saves would never
+// pay for itself before templates do. Each path then has a load band:
+// full network, shallow network, then templates as the price rises.
+constexpr float kShallowLoss = 0.005f;
+constexpr float kShallowLossPerComplexity = 0.0025f;
+
+} // namespace
+
+const char* generationPathName(GenerationPath path) {
+    switch (path) {
+        case GenerationPath::TEMPLATE: return "template";
+        case GenerationPath::SMALL_NETWORK: return "small_network";
+        case GenerationPath::LARGE_NETWORK: return "large_network";
+        default: return "unknown";
+    }
+}
+
+Router::Router() {
+    for (size_t i = 0; i < kPathCount; ++i) {
+        costs[i].store(kSeedCosts[i], std::memory_order_relaxed);
+        routed[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+std::array<float, Router::kPathCount> Router::estimateQuality(const CodeRequest& request,
+                                                              const PromptFeatures& features) {
+    // How far the request is past what a template covers; 1 at the limit
+    float complexity = static_cast<float>(
+        std::max(static_cast<double>(features.length) / kTemplatePromptLength,
+                 static_cast<double>(request.context.size()) / kTemplateContextLength));
+
+    std::array<float, kPathCount> quality{};
+    // Past the limit a template loses fit with every extra unit of
+    // complexity, more slowly when the prompt names an action a template
+    // is written around
+    float slope = features.action().empty() ? 0.2f : 0.1f;
+    quality[static_cast<size_t>(GenerationPath::TEMPLATE)] =
+        complexity <= 1.0f ? kTemplateQuality : std::max(0.1f, 0.8f - slope * (complexity - 1.0f));
+    // Skipping the hidden layers costs a little more the longer the prompt
+    quality[static_cast<size_t>(GenerationPath::SMALL_NETWORK)] =
+        kNetworkQuality - kShallowLoss - kShallowLossPerComplexity * std::min(complexity, 4.0f);
+    quality[static_cast<size_t>(GenerationPath::LARGE_NETWORK)] = kNetworkQuality;
+    return quality;
+}
+
+double Router::currentLoad(bool holds_slot) {
+    const Metrics::Gauges& gauges = Metrics::gauges();
+    int64_t workers = gauges.workers.load(std::memory_order_relaxed);
+    if (workers <= 0) return 0.0;
+    int64_t busy = gauges.active.load(std::memory_order_relaxed) +
+                   gauges.queued.load(std::memory_order_relaxed) - (holds_slot ? 1 : 0);
+    return static_cast<double>(std::max<int64_t>(busy, 0)) / static_cast<double>(workers);
+}
+
+RouteDecision Router::route(const CodeRequest& request, const PromptFeatures& features, double load) {
+    std::array<float, kPathCount> quality = estimateQuality(request, features);
+
+    GenerationPath best = GenerationPath::TEMPLATE;
+    if (load < 1.0) {
+        double price = kPricePerMicrosecond * load / (1.0 - load);
+        double best_utility = 0.0;
+        for (size_t i = 0; i < kPathCount; ++i) {
+            double utility = quality[i] - price * cost(static_cast<GenerationPath>(i));
+            // Ties go to the cheaper path, which comes first
+            if (i == 0 || utility > best_utility) {
+                best = static_cast<GenerationPath>(i);
+                best_utility = utility;
+            }
+        }
+    }
+
+    routed[static_cast<size_t>(best)].fetch_add(1, std::memory_order_relaxed);
+    return RouteDecision{best, quality[static_cast<size_t>(best)], cost(best)};
+}
+
+void Router::record(GenerationPath path, double microseconds) {
+    // Concurrent updates may drop a sample, which an average can afford
+    std::atomic<double>& average = costs[static_cast<size_t>(path)];
+    double current = average.load(std::memory_order_relaxed);
+    average.store(current + (microseconds - current) * kCostSmoothing, std::memory_order_relaxed);
+}
+
+double Router::cost(GenerationPath path) const {
+    return costs[static_cast<size_t>(path)].load(std::memory_order_relaxed);
+}
+
+uint64_t Router::routedCount(GenerationPath path) const {
+    return routed[static_cast<size_t>(path)].load(std::memory_order_relaxed);
+}
+
+std::string Router::formatPrometheus() const {
+    std::string out = "# HELP ai_engine_routed_requests_total Generation requests by the path routed to.\n"
+                      "# TYPE ai_engine_routed_requests_total counter\n";
+    for (size_t i = 0; i < kPathCount; ++i) {
+        GenerationPath path = static_cast<GenerationPath>(i);
+        out += "ai_engine_routed_requests_total{path=\"";
+        out += generationPathName(path);
+        out += "\"} " + std::to_string(routedCount(path)) + "\n";
+    }
+    out += "# HELP ai_engine_route_cost_seconds Moving average latency of each generation path.\n"
+           "# TYPE ai_engine_route_cost_seconds gauge\n";
+    for (size_t i = 0; i < kPathCount; ++i) {
+        GenerationPath path = static_cast<GenerationPath>(i);
+        char value[32];
+        std::snprintf(value, sizeof(value), "%.9f", cost(path) / 1e6);
+        out += "ai_engine_route_cost_seconds{path=\"";
+        out += generationPathName(path);
+        out += "\"} ";
+        out += value;
+        out += "\n";
+    }
+    return out;
+}
+
+Router& Router::shared() {
+    static Router instance;
+    return instance;
+}
+
+} // namespace AIEngine
@@ -0,0 +1,567 @@
+#include "ai_engine/shm.h"
+
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "ai_engine/wire.h"
+
+namespace AIEngine {
+
+// Futex wait/wake on a 32-bit word in memory shared between processes
+namespace Futex {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) &&
+              std::atomic<uint32_t>::is_always_lock_free,
+              "futex words must be plain lock-free 32-bit integers");
+
+inline void wait(std::atomic<uint32_t>& word, uint32_t expected, int timeout_ms) {
+    timespec timeout{timeout_ms / 1000, (timeout_ms % 1000) * 1000000L};
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected,
+              &timeout, nullptr, 0);
+}
+
+inline void wakeAll(std::atomic<uint32_t>& word) {
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX,
+              nullptr, nullptr, 0);
+}
+
+} // namespace Futex
+
+// Single-producer/single-consumer byte ring in shared memory.
+// Messages are stored as records of [u32 length][u32 flags][payload], padded
+// to 8 bytes and never split across the end of the ring (a padding record
+// fills the gap instead), so a consumer can decode a record in place.
+// Messages larger than half the ring are streamed as a chain of records.
+// Both sides sleep on futexes and only issue a wake syscall when the other
+// side has announced that it is waiting.
+class ShmRing {
+public:
+    struct Header {
+        uint64_t capacity;
+        alignas(64) std::atomic<uint64_t> head;
+        alignas(64) std::atomic<uint64_t> tail;
+        alignas(64) std::atomic<uint32_t> data_seq;
+        std::atomic<uint32_t> consumer_waiting;
+        alignas(64) std::atomic<uint32_t> space_seq;
+        std::atomic<uint32_t> producer_waiting;
+    };
+
+    static constexpr uint32_t kFlagMore = 1;  // message continues in the next record
+    static constexpr uint32_t kFlagPad = 2;   // filler up to the end of the ring
+    static constexpr uint32_t kFlagReset = 4; // drop any unfinished chain before it
+    static constexpr size_t kRecordHeaderSize = 8;
+
+private:
+    Header* header;
+    char* data;
+    uint64_t capacity;
+    uint64_t reserved_head;   // producer: start of the record being written
+    uint64_t peeked_size;     // consumer: size of the record returned by peek
+    std::string partial;      // consumer: chained records received so far
+
+public:
+    ShmRing() : header(nullptr), data(nullptr), capacity(0), reserved_head(0), peeked_size(0) {}
+
+    ShmRing(Header* ring_header, char* ring_data)
+        : header(ring_header), data(ring_data), capacity(ring_header->capacity),
+          reserved_head(0), peeked_size(0) {}
+
+    static void initialize(Header* ring_header, uint64_t ring_capacity) {
+        new (ring_header) Header();
+        ring_header->capacity = ring_capacity;
+    }
+
+    size_t maxRecordPayload() const { return capacity / 2 - kRecordHeaderSize; }
+
+    // Producer: space for a payload of length bytes, or nullptr on timeout.
+    // length must not exceed maxRecordPayload().
+    char* reserve(size_t length, int timeout_ms) {
+        uint64_t head = header->head.load(std::memory_order_relaxed);
+        uint64_t offset = head & (capacity - 1);
+        uint64_t contiguous = capacity - offset;
+        uint64_t needed = recordSize(length);
+        uint64_t total = needed <= contiguous ? needed : contiguous + needed;
+
+        if (!waitForSpace(head + total, timeout_ms)) return nullptr;
+
+        if (needed > contiguous) {
+            writeRecordHeader(offset, contiguous - kRecordHeaderSize, kFlagPad);
+            head += contiguous;
+            offset = 0;
+        }
+        reserved_head = head;
+        return data + offset + kRecordHeaderSize;
+    }
+
+    // Producer: publish the record returned by the last reserve()
+    void commit(size_t length, uint32_t flags) {
+        writeRecordHeader(reserved_head & (capacity - 1), length, flags);
+        header->head.store(reserved_head + recordSize(length));
+        header->data_seq.fetch_add(1);
+        if (header->consumer_waiting.load()) Futex::wakeAll(header->data_seq);
+    }
+
+    // Producer: copy a message of any size into the ring, chaining records
+    // when it does not fit in one. Returns false if the consumer stalled.
+    bool writeMessage(const char* message, size_t length, int timeout_ms) {
+        size_t chunk_limit = maxRecordPayload();
+        do {
+            size_t chunk = std::min(length, chunk_limit);
+            char* out = reserve(chunk, timeout_ms);
+            if (!out) return false;
+            std::memcpy(out, message, chunk);
+            message += chunk;
+            length -= chunk;
+            commit(chunk, length > 0 ? kFlagMore : 0);
+        } while (length > 0);
+        return true;
+    }
+
+    // Producer: make the consumer discard a chain an earlier producer left
+    // unfinished, e.g. one that died mid-message
+    bool writeReset(int timeout_ms) {
+        if (!reserve(0, timeout_ms)) return false;
+        commit(0, kFlagReset);
+        return true;
+    }
+
+    // Consumer: next record, skipping padding, or false on timeout or wakeConsumer()
+    bool peek(const char*& payload, size_t& length, uint32_t& flags, int timeout_ms) {
+        while (true) {
+            uint64_t tail = header->tail.load(std::memory_order_relaxed);
+            if (!waitForData(tail, timeout_ms)) return false;
+
+            const char* record = data + (tail & (capacity - 1));
+            uint32_t record_length;
+            std::memcpy(&record_length, record, sizeof(record_length));
+            std::memcpy(&flags, record + 4, sizeof(flags));
+            peeked_size = recordSize(record_length);
+
+            if (flags & kFlagPad) {
+                release();
+                continue;
+            }
+            payload = record + kRecordHeaderSize;
+            length = record_length;
+            return true;
+        }
+    }
+
+    // Consumer: hand the record returned by peek() back to the producer
+    void release() {
+        header->tail.store(header->tail.load(std::memory_order_relaxed) + peeked_size);
+        header->space_seq.fetch_add(1);
+        if (header->producer_waiting.load()) Futex::wakeAll(header->space_seq);
+    }
+
+    // Consumer: pass the next whole message to handler. Single-record
+    // messages are handed over in place; chained ones are reassembled.
+    // A timeout part-way through a chain keeps what was read for the next call.
+    template<typename Handler>
+    bool readMessage(Handler&& handler, int timeout_ms) {
+        const char* payload;
+        size_t length;
+        uint32_t flags;
+
+        while (peek(payload, length, flags, timeout_ms)) {
+            if (flags & kFlagReset) {
+                partial.clear();
+                release();
+                continue;
+            }
+            if (partial.empty() && !(flags & kFlagMore)) {
+                handler(payload, length);
+                release();
+                return true;
+            }
+
+            partial.append(payload, length);
+            release();
+            if (!(flags & kFlagMore)) {
+                std::string message;
+                message.swap(partial);
+                handler(message.data(), message.size());
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Wake a consumer blocked in peek(), e.g. on shutdown
+    void wakeConsumer() {
+        header->data_seq.fetch_add(1);
+        Futex::wakeAll(header->data_seq);
+    }
+
+private:
+    static uint64_t recordSize(size_t length) {
+        return (kRecordHeaderSize + length + 7) & ~uint64_t(7);
+    }
+
+    void writeRecordHeader(uint64_t offset, size_t length, uint32_t flags) {
+        uint32_t record_length = static_cast<uint32_t>(length);
+        std::memcpy(data + offset, &record_length, sizeof(record_length));
+        std::memcpy(data + offset + 4, &flags, sizeof(flags));
+    }
+
+    // The waiting flag is raised before re-checking, and the other side
+    // bumps the sequence before reading the flag, so no wakeup is lost
+    bool waitForSpace(uint64_t end, int timeout_ms) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        while (end - header->tail.load() > capacity) {
+            uint32_t seq = header->space_seq.load();
+            header->producer_waiting.store(1);
+            if (end - header->tail.load() > capacity) {
+                int remaining = remainingMs(deadline);
+                if (remaining <= 0) {
+                    header->producer_waiting.store(0);
+                    return false;
+                }
+                Futex::wait(header->space_seq, seq, remaining);
+            }
+            header->producer_waiting.store(0);
+        }
+        return true;
+    }
+
+    // Returns early (false) if woken without data, e.g. by wakeConsumer()
+    bool waitForData(uint64_t tail, int timeout_ms) {
+        if (header->head.load() != tail) return true;
+
+        uint32_t seq = header->data_seq.load();
+        header->consumer_waiting.store(1);
+        if (header->head.load() == tail) {
+            Futex::wait(header->data_seq, seq, timeout_ms);
+        }
+        header->consumer_waiting.store(0);
+        return header->head.load() != tail;
+    }
+
+    static int remainingMs(std::chrono::steady_clock::time_point deadline) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        return static_cast<int>(std::max<long long>(0, remaining));
+    }
+};
+// One POSIX shared memory segment holding a request ring (client to engine)
+// and a response ring (engine to client). The engine creates and owns the
+// segment; a single client process attaches to it at a time.
+class ShmChannel {
+public:
+    static constexpr uint32_t kMagic = 0x51454941;  // "AIEQ"
+    static constexpr uint32_t kVersion = 2;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t ring_capacity;
+        std::atomic<int32_t> server_pid;
+        std::atomic<int32_t> client_pid;
+        std::atomic<uint32_t> client_epoch;  // bumped by every client attach
+    };
+
+private:
+    static constexpr size_t kHeaderSize = 128;
+
+    std::string name;
+    void* base;
+    size_t size;
+    bool owner;
+    uint32_t attach_epoch;
+    ShmRing request_ring;
+    ShmRing response_ring;
+
+public:
+    // Engine side: create (or replace) the named segment
+    static std::unique_ptr<ShmChannel> create(const std::string& name, uint64_t ring_capacity) {
+        if (ring_capacity < 4096 || (ring_capacity & (ring_capacity - 1)) != 0) {
+            throw std::invalid_argument("Ring capacity must be a power of two of at least 4096");
+        }
+
+        ::shm_unlink(name.c_str());  // remove a stale segment from a previous run
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            throw std::runtime_error("shm_open " + name + " failed: " + std::strerror(errno));
+        }
+
+        size_t total = segmentSize(ring_capacity);
+        if (::ftruncate(fd, static_cast<off_t>(total)) < 0) {
+            std::string message = "ftruncate " + name + " failed: " + std::strerror(errno);
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            throw std::runtime_error(message);
+        }
+
+        void* base = mapSegment(fd, total, name);
+        auto* header = new (base) Header();
+        header->magic = kMagic;
+        header->version = kVersion;
+        header->ring_capacity = ring_capacity;
+        header->server_pid.store(static_cast<int32_t>(::getpid()));
+        header->client_pid.store(0);
+        ShmRing::initialize(ringHeader(base, ring_capacity, 0), ring_capacity);
+        ShmRing::initialize(ringHeader(base, ring_capacity, 1), ring_capacity);
+
+        return std::unique_ptr<ShmChannel>(new ShmChannel(name, base, total, true));
+    }
+
+    // Client side: attach to a segment created by the engine
+    static std::unique_ptr<ShmChannel> open(const std::string& name) {
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            throw std::runtime_error("shm_open " + name + " failed: " + std::strerror(errno));
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) < 0 || static_cast<size_t>(info.st_size) < kHeaderSize) {
+            ::close(fd);
+            throw std::runtime_error("Shared memory segment " + name + " is not initialised");
+        }
+
+        size_t total = static_cast<size_t>(info.st_size);
+        void* base = mapSegment(fd, total, name);
+        auto* header = static_cast<Header*>(base);
+        if (header->magic != kMagic || header->version != kVersion ||
+            segmentSize(header->ring_capacity) != total) {
+            ::munmap(base, total);
+            throw std::runtime_error("Shared memory segment " + name + " has an incompatible layout");
+        }
+
+        // Rings are single-consumer: claim the client slot, taking it over
+        // only if the previous client process has exited
+        int32_t self = static_cast<int32_t>(::getpid());
+        int32_t current = header->client_pid.load();
+        while (true) {
+            if (current != 0 && processAlive(current)) {
+                ::munmap(base, total);
+                throw std::runtime_error("Shared memory channel " + name +
+                                         " is in use by process " + std::to_string(current));
+            }
+            if (header->client_pid.compare_exchange_weak(current, self)) break;
+        }
+
+        std::unique_ptr<ShmChannel> channel(new ShmChannel(name, base, total, false));
+        channel->attach_epoch = header->client_epoch.fetch_add(1) + 1;
+        return channel;
+    }
+
+    ~ShmChannel() {
+        if (owner) {
+            ::shm_unlink(name.c_str());
+        } else {
+            header()->client_pid.store(0);
+        }
+        ::munmap(base, size);
+    }
+
+    ShmChannel(const ShmChannel&) = delete;
+    ShmChannel& operator=(const ShmChannel&) = delete;
+
+    ShmRing& requests() { return request_ring; }
+    ShmRing& responses() { return response_ring; }
+
+    // Distinguishes this client's requests from those of earlier clients,
+    // whose responses may still be in flight
+    uint32_t epoch() const { return attach_epoch; }
+
+    bool serverAlive() const {
+        return processAlive(header()->server_pid.load());
+    }
+
+private:
+    ShmChannel(const std::string& segment_name, void* segment, size_t segment_size, bool is_owner)
+        : name(segment_name), base(segment), size(segment_size), owner(is_owner), attach_epoch(0) {
+        uint64_t capacity = header()->ring_capacity;
+        request_ring = ShmRing(ringHeader(base, capacity, 0), ringData(base, capacity, 0));
+        response_ring = ShmRing(ringHeader(base, capacity, 1), ringData(base, capacity, 1));
+    }
+
+    Header* header() const { return static_cast<Header*>(base); }
+
+    static bool processAlive(int32_t pid) {
+        return pid > 0 && !(::kill(pid, 0) < 0 && errno == ESRCH);
+    }
+
+    static size_t segmentSize(uint64_t capacity) {
+        return kHeaderSize + 2 * (sizeof(ShmRing::Header) + capacity);
+    }
+
+    static ShmRing::Header* ringHeader(void* base, uint64_t capacity, int index) {
+        char* start = static_cast<char*>(base) + kHeaderSize +
+                      index * (sizeof(ShmRing::Header) + capacity);
+        return reinterpret_cast<ShmRing::Header*>(start);
+    }
+
+    static char* ringData(void* base, uint64_t capacity, int index) {
+        return reinterpret_cast<char*>(ringHeader(base, capacity, index)) + sizeof(ShmRing::Header);
+    }
+
+    static void* mapSegment(int fd, size_t total, const std::string& name) {
+        void* base = ::mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            throw std::runtime_error("mmap " + name + " failed: " + std::strerror(errno));
+        }
+        return base;
+    }
+};
+
+ShmServer::ShmServer(AIEngineServer& engine_ref, const std::string& name, size_t worker_count,
+                     uint64_t ring_capacity)
+    : engine(engine_ref), channel(ShmChannel::create(name, ring_capacity)),
+      stopping(false), pool(std::make_unique<WorkerPool>(worker_count)) {}
+
+ShmServer::~ShmServer() {
+    pool.reset();
+}
+
+void ShmServer::requestStop() {
+    stopping.store(true);
+    channel->requests().wakeConsumer();
+}
+
+void ShmServer::run() {
+    while (!stopping.load()) {
+        channel->requests().readMessage([this](const char* payload, size_t length) {
+            dispatch(payload, length);
+        }, kPollMs);
+    }
+}
+
+void ShmServer::dispatch(const char* payload, size_t length) {
+    uint32_t request_id;
+    CodeRequest request;
+    if (!Wire::decodeRequest(payload, length, request_id, request)) {
+        std::cerr << "Dropping malformed shared memory request\n";
+        return;
+    }
+    request.received_at = std::chrono::steady_clock::now();
+
+    pool->submit([this, request_id, request = std::move(request)]() {
+        std::string frame;
+        Wire::encodeResponse(request_id, engine.processRequest(request), frame);
+
+        std::lock_guard<std::mutex> lock(response_mutex);
+        if (!channel->responses().writeMessage(frame.data() + Wire::kLengthPrefixSize,
+                                               frame.size() - Wire::kLengthPrefixSize,
+                                               kResponseTimeoutMs)) {
+            std::cerr << "Shared memory client stopped reading; response dropped\n";
+        }
+    });
+}
+
+ShmClient::ShmClient(const std::string& name)
+    : channel(ShmChannel::open(name)), reader_active(false), next_request_id(1) {
+    // A client that died mid-request may have left part of a chained
+    // message in the request ring; the engine must not prepend it to ours
+    if (!channel->requests().writeReset(kPollMs * 10)) {
+        throw std::runtime_error("Engine is not consuming requests on " + name);
+    }
+}
+
+// Out of line, where ShmChannel is a complete type
+ShmClient::~ShmClient() = default;
+
+CodeResponse ShmClient::process(RequestType type, Language language, int max_tokens, float temperature,
+                                std::string_view prompt, std::string_view context, int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    uint32_t request_id = send(type, language, max_tokens, temperature, prompt, context, timeout_ms);
+
+    std::unique_lock<std::mutex> lock(receive_mutex);
+    while (true) {
+        auto it = ready.find(request_id);
+        if (it != ready.end()) {
+            CodeResponse response = std::move(it->second);
+            ready.erase(it);
+            pending.erase(request_id);
+            return response;
+        }
+
+        if (std::chrono::steady_clock::now() >= deadline) {
+            // A late response finds no pending id and is dropped
+            pending.erase(request_id);
+            throw std::runtime_error("Timed out waiting for the engine");
+        }
+
+        if (reader_active) {
+            receive_cv.wait_for(lock, std::chrono::milliseconds(kPollMs));
+            continue;
+        }
+
+        reader_active = true;
+        lock.unlock();
+        bool received = receiveOne();
+        lock.lock();
+        reader_active = false;
+        receive_cv.notify_all();
+
+        if (!received && !channel->serverAlive()) {
+            pending.erase(request_id);
+            throw std::runtime_error("Engine process serving the channel has exited");
+        }
+    }
+}
+
+uint32_t ShmClient::send(RequestType type, Language language, int max_tokens, float temperature,
+                         std::string_view prompt, std::string_view context, int timeout_ms) {
+    std::lock_guard<std::mutex> lock(send_mutex);
+    uint32_t request_id = (channel->epoch() << kEpochShift) | (next_request_id++ & kSequenceMask);
+    {
+        // Registered before the engine can see the request
+        std::lock_guard<std::mutex> receive_lock(receive_mutex);
+        pending.insert(request_id);
+    }
+    ShmRing& ring = channel->requests();
+    size_t payload_size = Wire::requestPayloadSize(prompt.size(), context.size());
+
+    bool sent;
+    if (payload_size <= ring.maxRecordPayload()) {
+        char* out = ring.reserve(payload_size, timeout_ms);
+        sent = out != nullptr;
+        if (sent) {
+            Wire::writeRequestPayload(out, request_id, type, language, max_tokens,
+                                      temperature, prompt, context);
+            ring.commit(payload_size, 0);
+        }
+    } else {
+        std::string payload(payload_size, '\0');
+        Wire::writeRequestPayload(&payload[0], request_id, type, language, max_tokens,
+                                  temperature, prompt, context);
+        sent = ring.writeMessage(payload.data(), payload.size(), timeout_ms);
+    }
+
+    if (!sent) {
+        std::lock_guard<std::mutex> receive_lock(receive_mutex);
+        pending.erase(request_id);
+        throw std::runtime_error("Engine is not consuming requests");
+    }
+    return request_id;
+}
+
+bool ShmClient::receiveOne() {
+    return channel->responses().readMessage([this](const char* payload, size_t length) {
+        uint32_t request_id;
+        CodeResponse response;
+        if (Wire::decodeResponse(payload, length, request_id, response)) {
+            // Responses to abandoned requests, or to an earlier client's,
+            // have no waiter left
+            std::lock_guard<std::mutex> lock(receive_mutex);
+            if (pending.count(request_id)) ready[request_id] = std::move(response);
+        }
+    }, kPollMs);
+}
+
+} // namespace AIEngine
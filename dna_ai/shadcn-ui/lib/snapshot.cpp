@@ -0,0 +1,319 @@
+#include "ai_engine/snapshot.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ai_engine/trace.h"
+
+namespace AIEngine {
+namespace Snapshot {
+
+namespace {
+
+// File layout, all integers in host byte order:
+//   Header
+//   network:   uint32 layer count, uint32 0, LayerRecord per layer, then
+//              each layer's weights and biases at 64-byte aligned offsets
+//   tokens:    string list in token id order
+//   templates: uint32 language count, then per language uint32 language,
+//              a string list of names and one of template sources, which
+//              are compiled on load
+// A string list is a uint32 count followed by uint32 length + bytes each.
+constexpr char kMagic[8] = {'A', 'I', 'E', 'S', 'N', 'A', 'P', '\0'};
+constexpr uint32_t kVersion = 2;
+constexpr uint32_t kByteOrderMark = 0x01020304;
+constexpr size_t kAlignment = 64;
+constexpr Language kTemplateLanguages[] = {Language::PYTHON, Language::CPP, Language::JAVASCRIPT,
+                                           Language::HTML, Language::CSS, Language::UNKNOWN};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t file_size;
+    uint64_t network_offset;
+    uint64_t tokens_offset;
+    uint64_t templates_offset;
+    uint64_t reserved;
+};
+
+struct LayerRecord {
+    uint32_t inputs;
+    uint32_t outputs;
+    uint32_t activation;
+    uint32_t reserved;
+    uint64_t weights_offset;
+    uint64_t biases_offset;
+};
+
+template<typename T>
+void appendPod(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+void writePod(std::string& out, size_t offset, const T& value) {
+    std::memcpy(&out[offset], &value, sizeof(value));
+}
+
+void alignTo(std::string& out, size_t alignment) {
+    out.resize((out.size() + alignment - 1) / alignment * alignment, '\0');
+}
+
+void appendStrings(std::string& out, const std::vector<std::string>& strings) {
+    appendPod(out, static_cast<uint32_t>(strings.size()));
+    for (const std::string& value : strings) {
+        appendPod(out, static_cast<uint32_t>(value.size()));
+        out += value;
+    }
+}
+
+size_t appendFloats(std::string& out, const float* values, size_t count) {
+    alignTo(out, kAlignment);
+    size_t offset = out.size();
+    out.append(reinterpret_cast<const char*>(values), count * sizeof(float));
+    return offset;
+}
+
+std::string encode(const NeuralNetwork& network, const TokenProcessor& tokenizer,
+                   const TemplateLibrary& templates) {
+    std::string out(sizeof(Header), '\0');
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byte_order = kByteOrderMark;
+
+    std::vector<NeuralNetwork::LayerView> layers = network.layerViews();
+    alignTo(out, kAlignment);
+    header.network_offset = out.size();
+    appendPod(out, static_cast<uint32_t>(layers.size()));
+    appendPod(out, uint32_t{0});
+    size_t records_offset = out.size();
+    out.resize(out.size() + layers.size() * sizeof(LayerRecord), '\0');
+
+    for (size_t i = 0; i < layers.size(); ++i) {
+        const NeuralNetwork::LayerView& layer = layers[i];
+        LayerRecord record{};
+        record.inputs = static_cast<uint32_t>(layer.inputs);
+        record.outputs = static_cast<uint32_t>(layer.outputs);
+        record.activation = static_cast<uint32_t>(layer.activation);
+        record.weights_offset = appendFloats(out, layer.weights, layer.inputs * layer.outputs);
+        record.biases_offset = appendFloats(out, layer.biases, layer.outputs);
+        writePod(out, records_offset + i * sizeof(LayerRecord), record);
+    }
+
+    header.tokens_offset = out.size();
+    appendStrings(out, tokenizer.vocabulary());
+
+    header.templates_offset = out.size();
+    std::vector<Language> languages;
+    for (Language language : kTemplateLanguages) {
+        if (!templates.templates(language).empty()) languages.push_back(language);
+    }
+    appendPod(out, static_cast<uint32_t>(languages.size()));
+    for (Language language : languages) {
+        std::vector<std::string> names;
+        std::vector<std::string> sources;
+        for (const TemplateLibrary::Template& entry : templates.templates(language)) {
+            names.push_back(entry.name);
+            sources.push_back(entry.compiled.source());
+        }
+        appendPod(out, static_cast<uint32_t>(language));
+        appendStrings(out, names);
+        appendStrings(out, sources);
+    }
+
+    header.file_size = out.size();
+    writePod(out, 0, header);
+    return out;
+}
+
+// Bounds-checked reads from the mapped file
+class Reader {
+private:
+    const char* base;
+    size_t size;
+    size_t position;
+    const std::string& path;
+
+public:
+    Reader(const char* data, size_t length, size_t offset, const std::string& file)
+        : base(data), size(length), position(offset), path(file) {
+        require(0);
+    }
+
+    void require(size_t bytes) const {
+        if (position > size || bytes > size - position) {
+            throw std::runtime_error("Snapshot " + path + " is truncated or corrupt");
+        }
+    }
+
+    template<typename T>
+    T read() {
+        require(sizeof(T));
+        T value;
+        std::memcpy(&value, base + position, sizeof(T));
+        position += sizeof(T);
+        return value;
+    }
+
+    std::vector<std::string> readStrings() {
+        uint32_t count = read<uint32_t>();
+        std::vector<std::string> strings;
+        strings.reserve(std::min<size_t>(count, size));
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t length = read<uint32_t>();
+            require(length);
+            strings.emplace_back(base + position, length);
+            position += length;
+        }
+        return strings;
+    }
+
+    const float* floatsAt(uint64_t offset, size_t count) const {
+        if (offset % alignof(float) != 0 || offset > size || count > (size - offset) / sizeof(float)) {
+            throw std::runtime_error("Snapshot " + path + " is truncated or corrupt");
+        }
+        return reinterpret_cast<const float*>(base + offset);
+    }
+};
+
+std::shared_ptr<const void> mapFile(const std::string& path, size_t& size) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) < 0) {
+        std::string message = "Cannot stat " + path + ": " + std::strerror(errno);
+        ::close(fd);
+        throw std::runtime_error(message);
+    }
+    size = static_cast<size_t>(info.st_size);
+    if (size < sizeof(Header)) {
+        ::close(fd);
+        throw std::runtime_error("Snapshot " + path + " is truncated or corrupt");
+    }
+
+    // Populated up front so the first requests do not take page faults
+    void* base = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        throw std::runtime_error("Cannot map " + path + ": " + std::strerror(errno));
+    }
+
+    size_t length = size;
+    return std::shared_ptr<const void>(base, [length](const void* memory) {
+        ::munmap(const_cast<void*>(memory), length);
+    });
+}
+
+} // namespace
+
+void save(const std::string& path) {
+    AI_TRACE_SCOPE("snapshot.save");
+    std::string data = encode(*NeuralNetwork::shared(), *TokenProcessor::shared(),
+                              *CodeGenerator::sharedTemplates());
+
+    std::string temporary = path + ".tmp." + std::to_string(::getpid());
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!file.flush()) {
+            std::remove(temporary.c_str());
+            throw std::runtime_error("Cannot write " + temporary);
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::string message = "Cannot rename " + temporary + " to " + path + ": " + std::strerror(errno);
+        std::remove(temporary.c_str());
+        throw std::runtime_error(message);
+    }
+}
+
+State load(const std::string& path) {
+    AI_TRACE_SCOPE("snapshot.load");
+    size_t size = 0;
+    std::shared_ptr<const void> mapping = mapFile(path, size);
+    const char* base = static_cast<const char*>(mapping.get());
+
+    Header header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.byte_order != kByteOrderMark) {
+        throw std::runtime_error("Snapshot " + path + " has an incompatible layout");
+    }
+    if (header.file_size != size) {
+        throw std::runtime_error("Snapshot " + path + " is truncated or corrupt");
+    }
+
+    Reader network_reader(base, size, header.network_offset, path);
+    uint32_t layer_count = network_reader.read<uint32_t>();
+    network_reader.read<uint32_t>();
+    std::vector<NeuralNetwork::LayerView> layers;
+    for (uint32_t i = 0; i < layer_count; ++i) {
+        LayerRecord record = network_reader.read<LayerRecord>();
+        if (record.activation > static_cast<uint32_t>(NeuralNetwork::Activation::TANH)) {
+            throw std::runtime_error("Snapshot " + path + " has an unknown activation");
+        }
+        NeuralNetwork::LayerView view;
+        view.inputs = record.inputs;
+        view.outputs = record.outputs;
+        view.activation = static_cast<NeuralNetwork::Activation>(record.activation);
+        view.weights = network_reader.floatsAt(record.weights_offset,
+                                               static_cast<size_t>(record.inputs) * record.outputs);
+        view.biases = network_reader.floatsAt(record.biases_offset, record.outputs);
+        layers.push_back(view);
+    }
+
+    Reader token_reader(base, size, header.tokens_offset, path);
+    std::vector<std::string> tokens = token_reader.readStrings();
+
+    Reader template_reader(base, size, header.templates_offset, path);
+    auto templates = std::make_shared<TemplateLibrary>();
+    uint32_t language_count = template_reader.read<uint32_t>();
+    for (uint32_t i = 0; i < language_count; ++i) {
+        uint32_t language = template_reader.read<uint32_t>();
+        std::vector<std::string> names = template_reader.readStrings();
+        std::vector<std::string> sources = template_reader.readStrings();
+        if (language > static_cast<uint32_t>(Language::UNKNOWN) || names.size() != sources.size()) {
+            throw std::runtime_error("Snapshot " + path + " is truncated or corrupt");
+        }
+        for (size_t j = 0; j < names.size(); ++j) {
+            templates->add(static_cast<Language>(language), std::move(names[j]), std::move(sources[j]));
+        }
+    }
+
+    State state;
+    state.network = std::make_shared<const NeuralNetwork>(layers, std::move(mapping));
+    state.tokenizer = std::make_shared<const TokenProcessor>(tokens);
+    state.templates = std::move(templates);
+    return state;
+}
+
+void restore(const std::string& path) {
+    State state = load(path);
+    // All or nothing: the model is installed only while the templates are
+    // held and known to be free, and the templates only if it was
+    bool installed = CodeGenerator::installSharedTemplates(state.templates, [&state] {
+        return NeuralNetwork::installShared(state.network, state.tokenizer);
+    });
+    if (!installed) {
+        throw std::runtime_error("Snapshot " + path + " restored after the engine was already in use");
+    }
+}
+
+} // namespace Snapshot
+} // namespace AIEngine
@@ -0,0 +1,222 @@
+#include "ai_engine/socket_server.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "ai_engine/metrics.h"
+#include "ai_engine/wire.h"
+
+namespace AIEngine {
+
+SocketServer::SocketServer(AIEngineServer& engine_ref, int listening_fd, size_t worker_count,
+                           IoBackendKind backend_kind, bool ordered)
+    : engine(engine_ref), listen_fd(listening_fd), ordered_responses(ordered),
+      next_connection_id(1), backend(makeIoBackend(backend_kind, listening_fd)),
+      pool(std::make_unique<WorkerPool>(worker_count)) {}
+
+SocketServer::~SocketServer() {
+    pool.reset();
+    Metrics::gauges().connections.fetch_sub(static_cast<int64_t>(connections.size()),
+                                            std::memory_order_relaxed);
+    backend.reset();
+    ::close(listen_fd);
+}
+
+void SocketServer::submit(uint64_t connection_id, Connection& conn, std::function<std::string()> job) {
+    uint64_t sequence = conn.next_sequence++;
+    conn.in_flight++;
+    pool->submit([this, connection_id, sequence, job = std::move(job)]() {
+        post(connection_id, sequence, job());
+    });
+}
+
+void SocketServer::closeWhenDone(uint64_t id, Connection& conn) {
+    if (conn.peer_closed) return;
+    conn.peer_closed = true;
+    backend->stopReceiving(id);
+}
+
+void SocketServer::pauseInput(uint64_t id, Connection& conn, size_t resume_at) {
+    conn.resume_at = resume_at;
+    if (conn.input_paused) return;
+    conn.input_paused = true;
+    if (!conn.peer_closed) backend->pauseReceiving(id);
+}
+
+void SocketServer::resumeInput(uint64_t id, Connection& conn) {
+    conn.input_paused = false;
+    if (!conn.peer_closed) backend->resumeReceiving(id);
+    if (!onInput(id, conn)) closeConnection(id);
+}
+
+void SocketServer::onAccepted(int fd) {
+    onAccept(fd);
+    uint64_t id = next_connection_id++;
+    connections[id];
+    Metrics::gauges().connections.fetch_add(1, std::memory_order_relaxed);
+    backend->addConnection(id, fd);
+}
+
+void SocketServer::onReceived(uint64_t id, const char* data, size_t size) {
+    auto it = connections.find(id);
+    if (it == connections.end()) return;
+    Connection& conn = it->second;
+
+    if (size == 0) {
+        // Orderly shutdown: answer what was already sent, then close
+        conn.peer_closed = true;
+        backend->stopReceiving(id);
+    } else {
+        conn.input.append(data, size);
+    }
+
+    if (!onInput(id, conn)) {
+        closeConnection(id);
+        return;
+    }
+    flush(id, conn);
+}
+
+void SocketServer::onSent(uint64_t id) {
+    auto it = connections.find(id);
+    if (it == connections.end()) return;
+    it->second.sending.clear();
+    flush(id, it->second);
+}
+
+void SocketServer::onFailed(uint64_t id) {
+    closeConnection(id);
+}
+
+void SocketServer::onWake() {
+    std::vector<Completion> batch;
+    {
+        std::lock_guard<std::mutex> lock(completed_mutex);
+        batch.swap(completed);
+    }
+
+    for (auto& item : batch) {
+        auto it = connections.find(item.connection_id);
+        if (it == connections.end()) continue;  // connection closed meanwhile
+
+        Connection& conn = it->second;
+        conn.in_flight--;
+        deliver(conn, item.sequence, std::move(item.bytes));
+        if (conn.input_paused && conn.in_flight <= conn.resume_at) {
+            resumeInput(item.connection_id, conn);
+            it = connections.find(item.connection_id);
+            if (it == connections.end()) continue;
+        }
+        flush(item.connection_id, it->second);
+    }
+}
+
+void SocketServer::deliver(Connection& conn, uint64_t sequence, std::string bytes) {
+    if (!ordered_responses) {
+        conn.output.append(bytes);
+        return;
+    }
+
+    conn.held.emplace(sequence, std::move(bytes));
+    while (!conn.held.empty() && conn.held.begin()->first == conn.next_to_write) {
+        conn.output.append(conn.held.begin()->second);
+        conn.held.erase(conn.held.begin());
+        conn.next_to_write++;
+    }
+}
+
+void SocketServer::post(uint64_t connection_id, uint64_t sequence, std::string bytes) {
+    {
+        std::lock_guard<std::mutex> lock(completed_mutex);
+        completed.push_back(Completion{connection_id, sequence, std::move(bytes)});
+    }
+    backend->wake();
+}
+
+void SocketServer::flush(uint64_t id, Connection& conn) {
+    if (!conn.sending.empty()) return;
+
+    if (!conn.output.empty()) {
+        conn.sending.swap(conn.output);
+        backend->send(id, conn.sending.data(), conn.sending.size());
+        return;
+    }
+
+    if (conn.peer_closed && conn.in_flight == 0) {
+        closeConnection(id);
+    }
+}
+
+void SocketServer::closeConnection(uint64_t id) {
+    if (connections.erase(id) > 0) {
+        Metrics::gauges().connections.fetch_sub(1, std::memory_order_relaxed);
+        backend->closeConnection(id);
+    }
+}
+
+DaemonServer::~DaemonServer() {
+    ::unlink(path.c_str());
+}
+
+int DaemonServer::openUnixSocket(const std::string& socket_path) {
+    sockaddr_un address{};
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + socket_path);
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("socket failed: ") + std::strerror(errno));
+    }
+
+    ::unlink(socket_path.c_str());  // remove a stale socket from a previous run
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(fd, SOMAXCONN) < 0) {
+        std::string message = std::string("Cannot listen on ") + socket_path + ": " + std::strerror(errno);
+        ::close(fd);
+        throw std::runtime_error(message);
+    }
+    return fd;
+}
+
+bool DaemonServer::onInput(uint64_t connection_id, Connection& conn) {
+    size_t offset = 0;
+    uint32_t payload_length;
+
+    while (Wire::peekFrameLength(conn.input, offset, payload_length)) {
+        if (conn.in_flight >= kMaxInFlight) {
+            pauseInput(connection_id, conn, kMaxInFlight / 2);
+            break;
+        }
+        if (payload_length > Wire::kMaxFrameSize) return false;
+        if (conn.input.size() - offset < Wire::kLengthPrefixSize + payload_length) break;
+
+        uint32_t request_id;
+        CodeRequest request;
+        if (!Wire::decodeRequest(conn.input.data() + offset + Wire::kLengthPrefixSize,
+                                 payload_length, request_id, request)) {
+            return false;
+        }
+        offset += Wire::kLengthPrefixSize + payload_length;
+        request.received_at = std::chrono::steady_clock::now();
+
+        submit(connection_id, conn, [this, request_id, request = std::move(request)]() {
+            std::string frame;
+            Wire::encodeResponse(request_id, engine.processRequest(request), frame);
+            return frame;
+        });
+    }
+
+    conn.input.erase(0, offset);
+    return true;
+}
+
+} // namespace AIEngine
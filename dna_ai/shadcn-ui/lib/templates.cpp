@@ -0,0 +1,400 @@
+#include "ai_engine/templates.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+
+#include "ai_engine/io_backend.h"
+#include "ai_engine/kernels.h"
+#include "ai_engine/trace.h"
+
+namespace AIEngine {
+
+namespace {
+
+// A word of a template name counts this much more than one of its text
+constexpr float kNameWeight = 3.0f;
+// Weight of the embedding similarity next to the keyword score, and the
+// similarity a template needs to be selected without a shared keyword
+constexpr float kSimilarityWeight = 1.0f;
+constexpr float kMinSimilarity = 0.5f;
+// Clusters whose templates select() compares with the prompt, and the
+// k-means iterations that fit their centroids
+constexpr size_t kProbedClusters = 3;
+constexpr size_t kClusterIterations = 5;
+
+bool isStopWord(std::string_view word) {
+    static constexpr std::string_view kStopWords[] = {
+        "a", "an", "and", "as", "at", "be", "by", "for", "in", "is", "it", "me",
+        "of", "on", "or", "that", "the", "this", "to", "with"
+    };
+    for (std::string_view stop : kStopWords) {
+        if (word == stop) return true;
+    }
+    return false;
+}
+
+bool endsWith(const std::string& word, std::string_view suffix) {
+    return word.size() >= suffix.size() && word.compare(word.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Strips common English inflections so that "sorting", "sorted" and "sort",
+// or "parser" and "parse", index as one keyword. Only ever compared with
+// words stemmed the same way, so the stems need not be real words.
+void stem(std::string& word) {
+    if (word.size() <= 4) return;
+    if (endsWith(word, "ies")) {
+        word.replace(word.size() - 3, 3, "y");
+    } else if (endsWith(word, "sses") || endsWith(word, "shes") || endsWith(word, "ches") ||
+               endsWith(word, "xes")) {
+        word.resize(word.size() - 2);
+    } else if (endsWith(word, "s") && !endsWith(word, "ss") && !endsWith(word, "us")) {
+        word.pop_back();
+    }
+    for (std::string_view suffix : {"ing", "ed", "er"}) {
+        if (endsWith(word, suffix) && word.size() - suffix.size() >= 3) {
+            word.resize(word.size() - suffix.size());
+            break;
+        }
+    }
+    if (word.size() > 3 && word.back() == 'e') {
+        word.pop_back();
+    }
+}
+
+// Calls f with each lowercased, stemmed alphanumeric word of text that is
+// not a stop word
+template<typename F>
+void forEachWord(std::string_view text, F f) {
+    std::string word;
+    for (size_t i = 0; i <= text.size(); ++i) {
+        unsigned char c = i < text.size() ? static_cast<unsigned char>(text[i]) : ' ';
+        if (std::isalnum(c)) {
+            word += static_cast<char>(std::tolower(c));
+        } else if (!word.empty()) {
+            if (!isStopWord(word)) {
+                stem(word);
+                f(word);
+            }
+            word.clear();
+        }
+    }
+}
+
+void addTerm(std::vector<std::pair<std::string, float>>& terms, const std::string& word, float weight) {
+    for (auto& term : terms) {
+        if (term.first == word) {
+            term.second = std::max(term.second, weight);
+            return;
+        }
+    }
+    terms.emplace_back(word, weight);
+}
+
+} // namespace
+
+CompiledTemplate::CompiledTemplate(std::string source)
+    : text(std::move(source)), literal_size(0), used_slots(0) {
+    size_t literal_start = 0;
+    size_t position = 0;
+
+    while ((position = text.find('{', position)) != std::string::npos) {
+        size_t close = text.find('}', position + 1);
+        if (close == std::string::npos) break;
+
+        Slot slot = slotNamed(std::string_view(text).substr(position + 1, close - position - 1));
+        if (slot == Slot::NONE) {
+            ++position;
+            continue;
+        }
+
+        segments.push_back(Segment{static_cast<uint32_t>(literal_start),
+                                   static_cast<uint32_t>(position - literal_start), slot});
+        literal_size += position - literal_start;
+        used_slots |= 1u << static_cast<unsigned>(slot);
+        literal_start = close + 1;
+        position = close + 1;
+    }
+
+    segments.push_back(Segment{static_cast<uint32_t>(literal_start),
+                               static_cast<uint32_t>(text.size() - literal_start), Slot::NONE});
+    literal_size += text.size() - literal_start;
+}
+
+std::string CompiledTemplate::render(const Values& values) const {
+    size_t total = literal_size;
+    for (const Segment& segment : segments) {
+        if (segment.slot != Slot::NONE) {
+            total += values[static_cast<size_t>(segment.slot)].size();
+        }
+    }
+
+    std::string result;
+    result.reserve(total);
+    for (const Segment& segment : segments) {
+        result.append(text, segment.offset, segment.length);
+        if (segment.slot != Slot::NONE) {
+            result += values[static_cast<size_t>(segment.slot)];
+        }
+    }
+    return result;
+}
+
+std::vector<std::string_view> CompiledTemplate::literals() const {
+    std::vector<std::string_view> runs;
+    runs.reserve(segments.size());
+    for (const Segment& segment : segments) {
+        runs.push_back(std::string_view(text).substr(segment.offset, segment.length));
+    }
+    return runs;
+}
+
+CompiledTemplate::Slot CompiledTemplate::slotNamed(std::string_view name) {
+    if (name == "function_name") return Slot::FUNCTION_NAME;
+    if (name == "class_name") return Slot::CLASS_NAME;
+    if (name == "description") return Slot::DESCRIPTION;
+    if (name == "body") return Slot::BODY;
+    if (name == "params") return Slot::PARAMS;
+    if (name == "return_type") return Slot::RETURN_TYPE;
+    if (name == "main_body") return Slot::MAIN_BODY;
+    return Slot::NONE;
+}
+
+void TemplateLibrary::add(Language language, std::string name, std::string source) {
+    size_t index = static_cast<size_t>(language);
+    auto existing = by_name[index].find(name);
+    if (existing != by_name[index].end()) {
+        // Postings of the old text cannot be told apart, so reindex all
+        by_language[index][existing->second].compiled = CompiledTemplate(std::move(source));
+        indexes[index] = Index();
+        for (size_t i = 0; i < by_language[index].size(); ++i) {
+            indexTemplate(indexes[index], static_cast<uint32_t>(i), by_language[index][i]);
+        }
+        return;
+    }
+    uint32_t position = static_cast<uint32_t>(by_language[index].size());
+    by_name[index].emplace(name, position);
+    by_language[index].push_back(Template{std::move(name), CompiledTemplate(std::move(source))});
+    indexTemplate(indexes[index], position, by_language[index].back());
+    count++;
+}
+
+void TemplateLibrary::indexTemplate(Index& index, uint32_t position, const Template& entry) {
+    std::vector<std::pair<std::string, float>> terms;
+    forEachWord(entry.name, [&](const std::string& word) { addTerm(terms, word, kNameWeight); });
+    for (std::string_view literal : entry.compiled.literals()) {
+        forEachWord(literal, [&](const std::string& word) { addTerm(terms, word, 1.0f); });
+    }
+
+    for (const auto& term : terms) {
+        index.postings[term.first].push_back(Posting{position, term.second});
+    }
+    index.embeddings.resize(index.embeddings.size() + kEmbeddingSize);
+    float* embedding = index.embeddings.data() + static_cast<size_t>(position) * kEmbeddingSize;
+    embed(terms, embedding);
+
+    size_t templates = static_cast<size_t>(position) + 1;
+    if (templates >= 2 * index.clustered) {
+        fitClusters(index, templates);
+    } else {
+        index.clusters[nearestCentroid(index, embedding)].push_back(position);
+    }
+}
+
+// Spherical k-means over about sqrt(n) clusters, seeded with evenly spaced
+// templates so that the fit is deterministic
+void TemplateLibrary::fitClusters(Index& index, size_t templates) {
+    size_t count = std::max<size_t>(1, static_cast<size_t>(std::lround(std::sqrt(static_cast<double>(templates)))));
+    index.centroids.assign(count * kEmbeddingSize, 0.0f);
+    for (size_t c = 0; c < count; ++c) {
+        const float* seed = index.embeddings.data() + (c * templates / count) * kEmbeddingSize;
+        std::copy(seed, seed + kEmbeddingSize, index.centroids.data() + c * kEmbeddingSize);
+    }
+
+    std::vector<uint32_t> assignment(templates);
+    for (size_t iteration = 0;; ++iteration) {
+        for (size_t i = 0; i < templates; ++i) {
+            assignment[i] = static_cast<uint32_t>(nearestCentroid(index, index.embeddings.data() + i * kEmbeddingSize));
+        }
+        if (iteration == kClusterIterations) break;
+
+        // Each centroid moves to the normalised mean of its templates; one
+        // left without any stays where it is
+        std::vector<float> sums(count * kEmbeddingSize, 0.0f);
+        for (size_t i = 0; i < templates; ++i) {
+            const float* embedding = index.embeddings.data() + i * kEmbeddingSize;
+            float* sum = sums.data() + assignment[i] * kEmbeddingSize;
+            for (size_t d = 0; d < kEmbeddingSize; ++d) sum[d] += embedding[d];
+        }
+        for (size_t c = 0; c < count; ++c) {
+            float* sum = sums.data() + c * kEmbeddingSize;
+            float norm = std::sqrt(Kernels::dot(sum, sum, kEmbeddingSize));
+            if (norm <= 0.0f) continue;
+            for (size_t d = 0; d < kEmbeddingSize; ++d) index.centroids[c * kEmbeddingSize + d] = sum[d] / norm;
+        }
+    }
+
+    index.clusters.assign(count, {});
+    for (size_t i = 0; i < templates; ++i) {
+        index.clusters[assignment[i]].push_back(static_cast<uint32_t>(i));
+    }
+    index.clustered = templates;
+}
+
+size_t TemplateLibrary::nearestCentroid(const Index& index, const float* embedding) {
+    size_t best = 0;
+    float best_similarity = 0.0f;
+    for (size_t c = 0; c * kEmbeddingSize < index.centroids.size(); ++c) {
+        float similarity = Kernels::dot(embedding, index.centroids.data() + c * kEmbeddingSize, kEmbeddingSize);
+        if (c == 0 || similarity > best_similarity) {
+            best = c;
+            best_similarity = similarity;
+        }
+    }
+    return best;
+}
+
+const CompiledTemplate* TemplateLibrary::select(Language language, std::string_view prompt) const {
+    AI_TRACE_SCOPE("selectTemplate");
+    size_t language_index = static_cast<size_t>(language);
+    const std::vector<Template>& entries = by_language[language_index];
+    if (entries.empty()) return nullptr;
+    const Index& index = indexes[language_index];
+
+    std::vector<std::pair<std::string, float>> words;
+    forEachWord(prompt, [&](const std::string& word) { addTerm(words, word, 1.0f); });
+
+    // Keyword candidates: sum of matching posting weights scaled by the
+    // BM25 inverse document frequency of the keyword, merged by template
+    std::vector<Posting> candidates;
+    const float total = static_cast<float>(entries.size());
+    for (const auto& word : words) {
+        auto it = index.postings.find(word.first);
+        if (it == index.postings.end()) continue;
+        float frequency = static_cast<float>(it->second.size());
+        float idf = std::log((total - frequency + 0.5f) / (frequency + 0.5f) + 1.0f);
+        for (const Posting& posting : it->second) {
+            candidates.push_back(Posting{posting.index, idf * posting.weight});
+        }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const Posting& a, const Posting& b) { return a.index < b.index; });
+    size_t merged = 0;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (merged > 0 && candidates[merged - 1].index == candidates[i].index) {
+            candidates[merged - 1].weight += candidates[i].weight;
+        } else {
+            candidates[merged++] = candidates[i];
+        }
+    }
+    candidates.resize(merged);
+
+    float query[kEmbeddingSize];
+    embed(words, query);
+
+    // Ties go to the template added first, as in a scan in order
+    const CompiledTemplate* best = nullptr;
+    uint32_t best_index = 0;
+    float best_score = 0.0f;
+    auto consider = [&](uint32_t i, float keyword_score) {
+        float similarity = Kernels::dot(query, index.embeddings.data() + static_cast<size_t>(i) * kEmbeddingSize,
+                                        kEmbeddingSize);
+        if (keyword_score <= 0.0f && similarity < kMinSimilarity) return;
+        float score = keyword_score + kSimilarityWeight * similarity;
+        if (!best || score > best_score || (score == best_score && i < best_index)) {
+            best = &entries[i].compiled;
+            best_index = i;
+            best_score = score;
+        }
+    };
+    for (const Posting& candidate : candidates) {
+        consider(candidate.index, candidate.weight);
+    }
+
+    // Similarity candidates without a shared keyword: the templates of the
+    // clusters whose centroids are nearest the prompt
+    const size_t cluster_count = index.clusters.size();
+    std::vector<std::pair<float, uint32_t>> nearest(cluster_count);
+    for (size_t c = 0; c < cluster_count; ++c) {
+        nearest[c] = {-Kernels::dot(query, index.centroids.data() + c * kEmbeddingSize, kEmbeddingSize),
+                      static_cast<uint32_t>(c)};
+    }
+    const size_t probed = std::min(kProbedClusters, cluster_count);
+    std::partial_sort(nearest.begin(), nearest.begin() + static_cast<std::ptrdiff_t>(probed), nearest.end());
+    for (size_t p = 0; p < probed; ++p) {
+        for (uint32_t i : index.clusters[nearest[p].second]) {
+            auto found = std::lower_bound(candidates.begin(), candidates.end(), i,
+                                          [](const Posting& posting, uint32_t value) { return posting.index < value; });
+            if (found == candidates.end() || found->index != i) consider(i, 0.0f);
+        }
+    }
+    return best;
+}
+
+void TemplateLibrary::embed(const std::vector<std::pair<std::string, float>>& words, float* out) {
+    std::fill(out, out + kEmbeddingSize, 0.0f);
+    std::string padded;
+    for (const auto& word : words) {
+        padded = "^" + word.first + "$";
+        for (size_t i = 0; i + 3 <= padded.size(); ++i) {
+            // FNV-1a of the trigram picks the bucket and the sign
+            uint32_t hash = 2166136261u;
+            for (size_t j = i; j < i + 3; ++j) {
+                hash = (hash ^ static_cast<unsigned char>(padded[j])) * 16777619u;
+            }
+            out[hash % kEmbeddingSize] += (hash & 0x80000000u) ? -word.second : word.second;
+        }
+    }
+
+    float norm = std::sqrt(Kernels::dot(out, out, kEmbeddingSize));
+    if (norm > 0.0f) {
+        for (size_t i = 0; i < kEmbeddingSize; ++i) out[i] /= norm;
+    }
+}
+
+const std::vector<TemplateLibrary::Template>& TemplateLibrary::templates(Language language) const {
+    return by_language[static_cast<size_t>(language)];
+}
+
+const CompiledTemplate* TemplateLibrary::find(Language language, std::string_view name) const {
+    size_t index = static_cast<size_t>(language);
+    auto it = by_name[index].find(name);
+    return it != by_name[index].end() ? &by_language[index][it->second].compiled : nullptr;
+}
+
+TemplateLibrary TemplateLibrary::loadDirectory(const std::string& path) {
+    namespace fs = std::filesystem;
+    std::error_code error;
+    if (!fs::is_directory(path, error)) {
+        throw std::runtime_error("Template directory " + path + " not found");
+    }
+
+    // Files are added in name order, so the order within a language does
+    // not depend on the file system
+    std::vector<fs::path> files;
+    for (const auto& language_dir : fs::directory_iterator(path)) {
+        if (!language_dir.is_directory() || stringToLanguage(language_dir.path().filename().string()) ==
+                                                Language::UNKNOWN) {
+            continue;
+        }
+        for (const auto& file : fs::directory_iterator(language_dir.path())) {
+            std::string name = file.path().filename().string();
+            if (file.is_regular_file() && !name.empty() && name[0] != '.') {
+                files.push_back(file.path());
+            }
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    TemplateLibrary library;
+    for (const fs::path& file : files) {
+        Language language = stringToLanguage(file.parent_path().filename().string());
+        library.add(language, file.stem().string(), readFileContents(file.string()));
+    }
+    return library;
+}
+
+} // namespace AIEngine
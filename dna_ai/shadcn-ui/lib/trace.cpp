@@ -0,0 +1,85 @@
+#include "ai_engine/trace.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace AIEngine {
+namespace Trace {
+
+void Ring::copyTo(std::vector<Copy>& out) const {
+    uint64_t end = head.load(std::memory_order_acquire);
+    uint64_t begin = end > kCapacity ? end - kCapacity : 0;
+    size_t first = out.size();
+
+    for (uint64_t i = begin; i < end; ++i) {
+        const Event& event = events[i & (kCapacity - 1)];
+        out.push_back(Copy{event.name.load(std::memory_order_relaxed),
+                           event.start.load(std::memory_order_relaxed),
+                           event.duration.load(std::memory_order_relaxed)});
+    }
+
+    // Slots the writer reached while we copied may hold newer events
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t now = claimed.load(std::memory_order_relaxed);
+    uint64_t torn = now > begin + kCapacity ? std::min(now - kCapacity - begin, end - begin) : 0;
+    out.erase(out.begin() + static_cast<std::ptrdiff_t>(first),
+              out.begin() + static_cast<std::ptrdiff_t>(first + torn));
+}
+
+Ring& Registry::local() {
+    thread_local Ring* ring = nullptr;
+    if (ring == nullptr) {
+        auto owned = std::make_unique<Ring>(static_cast<long>(::syscall(SYS_gettid)));
+        ring = owned.get();
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        rings.push_back(std::move(owned));
+    }
+    return *ring;
+}
+
+std::string Registry::exportChrome() {
+    std::vector<std::pair<long, std::vector<Ring::Copy>>> threads;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        for (const auto& ring : rings) {
+            threads.emplace_back(ring->threadId(), std::vector<Ring::Copy>());
+            ring->copyTo(threads.back().second);
+        }
+    }
+
+    long pid = static_cast<long>(::getpid());
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    char line[160];
+
+    for (const auto& thread : threads) {
+        for (const Ring::Copy& event : thread.second) {
+            if (event.name == nullptr) continue;
+            if (!first) out += ",\n";
+            first = false;
+
+            // Span names are literals that need no JSON escaping
+            out += "{\"name\":\"";
+            out += event.name;
+            out += "\"";
+            int length = std::snprintf(line, sizeof(line),
+                                       ",\"cat\":\"engine\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                                       "\"pid\":%ld,\"tid\":%ld}",
+                                       static_cast<double>(event.start) / 1000.0,
+                                       static_cast<double>(event.duration) / 1000.0, pid, thread.first);
+            out.append(line, static_cast<size_t>(std::max(0, length)));
+        }
+    }
+    out += "]}\n";
+    return out;
+}
+
+std::string exportChrome() {
+    return registry().exportChrome();
+}
+
+} // namespace Trace
+} // namespace AIEngine
@@ -0,0 +1,32 @@
+#include "ai_engine/types.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace AIEngine {
+
+Language stringToLanguage(const std::string& lang_str) {
+    std::string lower = lang_str;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+    if (lower == "python" || lower == "py") return Language::PYTHON;
+    if (lower == "cpp" || lower == "c++" || lower == "cxx") return Language::CPP;
+    if (lower == "javascript" || lower == "js") return Language::JAVASCRIPT;
+    if (lower == "html") return Language::HTML;
+    if (lower == "css") return Language::CSS;
+
+    return Language::UNKNOWN;
+}
+
+std::string languageToString(Language lang) {
+    switch (lang) {
+        case Language::PYTHON: return "Python";
+        case Language::CPP: return "C++";
+        case Language::JAVASCRIPT: return "JavaScript";
+        case Language::HTML: return "HTML";
+        case Language::CSS: return "CSS";
+        default: return "Unknown";
+    }
+}
+
+} // namespace AIEngine
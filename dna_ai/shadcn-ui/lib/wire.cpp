@@ -0,0 +1,94 @@
+#include "ai_engine/wire.h"
+
+namespace AIEngine {
+namespace Wire {
+
+void writeRequestPayload(char* out, uint32_t request_id, RequestType type, Language language,
+                         int max_tokens, float temperature,
+                         std::string_view prompt, std::string_view context) {
+    Writer writer(out);
+    writer.putU32(request_id);
+    writer.putU8(static_cast<uint8_t>(type));
+    writer.putU8(static_cast<uint8_t>(language));
+    writer.putU16(0);
+    writer.putU32(static_cast<uint32_t>(max_tokens));
+    writer.putF32(temperature);
+    writer.putString(prompt);
+    writer.putString(context);
+}
+
+void encodeRequest(uint32_t request_id, const CodeRequest& request, std::string& out) {
+    size_t payload_size = requestPayloadSize(request.prompt.size(), request.context.size());
+    size_t frame_start = out.size();
+    out.resize(frame_start + kLengthPrefixSize + payload_size);
+
+    Writer(&out[frame_start]).putU32(static_cast<uint32_t>(payload_size));
+    writeRequestPayload(&out[frame_start + kLengthPrefixSize], request_id, request.type,
+                        request.language, request.max_tokens, request.temperature,
+                        request.prompt, request.context);
+}
+
+bool decodeRequest(const char* payload, size_t length, uint32_t& request_id, CodeRequest& request) {
+    Reader reader(payload, length);
+    uint8_t type, language;
+    uint16_t reserved;
+    uint32_t max_tokens;
+
+    if (!reader.getU32(request_id) || !reader.getU8(type) || !reader.getU8(language) ||
+        !reader.getU16(reserved) || !reader.getU32(max_tokens) ||
+        !reader.getF32(request.temperature) || !reader.getString(request.prompt) ||
+        !reader.getString(request.context) || !reader.atEnd()) {
+        return false;
+    }
+
+    if (type > static_cast<uint8_t>(RequestType::OPTIMIZE_CODE)) return false;
+    if (language > static_cast<uint8_t>(Language::UNKNOWN)) {
+        language = static_cast<uint8_t>(Language::UNKNOWN);
+    }
+
+    request.type = static_cast<RequestType>(type);
+    request.language = static_cast<Language>(language);
+    request.max_tokens = static_cast<int>(max_tokens);
+    return true;
+}
+
+void encodeResponse(uint32_t request_id, const CodeResponse& response, std::string& out) {
+    size_t payload_size = kResponseFixedSize + response.code.size() + response.explanation.size() +
+                          response.execution_result.size() + response.error.size();
+    size_t frame_start = out.size();
+    out.resize(frame_start + kLengthPrefixSize + payload_size);
+
+    Writer writer(&out[frame_start]);
+    writer.putU32(static_cast<uint32_t>(payload_size));
+    writer.putU32(request_id);
+    writer.putU8(response.error.empty() ? 0 : 1);
+    writer.putU8(0);
+    writer.putU16(0);
+    writer.putF32(response.confidence);
+    writer.putU32(static_cast<uint32_t>(response.processing_time.count()));
+    writer.putString(response.code);
+    writer.putString(response.explanation);
+    writer.putString(response.execution_result);
+    writer.putString(response.error);
+}
+
+bool decodeResponse(const char* payload, size_t length, uint32_t& request_id, CodeResponse& response) {
+    Reader reader(payload, length);
+    uint8_t status, reserved8;
+    uint16_t reserved16;
+    uint32_t processing_time_ms;
+
+    if (!reader.getU32(request_id) || !reader.getU8(status) || !reader.getU8(reserved8) ||
+        !reader.getU16(reserved16) || !reader.getF32(response.confidence) ||
+        !reader.getU32(processing_time_ms) || !reader.getString(response.code) ||
+        !reader.getString(response.explanation) || !reader.getString(response.execution_result) ||
+        !reader.getString(response.error) || !reader.atEnd()) {
+        return false;
+    }
+
+    response.processing_time = std::chrono::milliseconds(processing_time_ms);
+    return true;
+}
+
+} // namespace Wire
+} // namespace AIEngine
@@ -0,0 +1,72 @@
+#include "ai_engine/worker_pool.h"
+
+#include "ai_engine/metrics.h"
+
+namespace AIEngine {
+
+namespace {
+
+thread_local bool running_task = false;
+
+} // namespace
+
+WorkerPool::WorkerPool(size_t thread_count) : stopping(false) {
+    if (thread_count == 0) thread_count = 1;
+    for (size_t i = 0; i < thread_count; ++i) {
+        workers.emplace_back([this]() { workerLoop(); });
+    }
+    Metrics::gauges().workers.fetch_add(static_cast<int64_t>(thread_count), std::memory_order_relaxed);
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stopping = true;
+    }
+    queue_cv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    Metrics::gauges().workers.fetch_sub(static_cast<int64_t>(workers.size()), std::memory_order_relaxed);
+}
+
+void WorkerPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        tasks.push(std::move(task));
+    }
+    Metrics::gauges().queued.fetch_add(1, std::memory_order_relaxed);
+    queue_cv.notify_one();
+}
+
+size_t WorkerPool::pending() {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    return tasks.size();
+}
+
+bool WorkerPool::runningTask() {
+    return running_task;
+}
+
+void WorkerPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_cv.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+
+        Metrics::Gauges& gauges = Metrics::gauges();
+        gauges.queued.fetch_sub(1, std::memory_order_relaxed);
+        gauges.active.fetch_add(1, std::memory_order_relaxed);
+        running_task = true;
+        task();
+        running_task = false;
+        gauges.active.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace AIEngine